@@ -0,0 +1,348 @@
+/*--------------------------------------------------------------------
+@file            : bench.c
+@brief           : Host benchmark of the button manager.
+                   Runs 1 to 100k simulated buttons (and groups) with a
+                   press pattern, and reports the time of z_btnmgr_tick,
+                   the events per second and the memory per button.
+----------------------------------------------------------------------
+@attention       :
+    Build on the host (POSIX), with the same options as the target:
+      gcc -O2 -o bench bench/bench.c src/z_btnmgr.c
+      gcc -O2 -DZ_BTNMGR_MAX_BTNS=65535 -o bench_pool bench/bench.c src/z_btnmgr.c
+      gcc -O2 -DZ_BTNMGR_MAX_BTNS=65535 -DZ_BTNMGR_WHEEL_BITS=6 -o bench_wheel bench/bench.c src/z_btnmgr.c
+      gcc -O2 -DZ_BTNMGR_EVENT_QUEUE_SIZE=4096 -o bench_queue bench/bench.c src/z_btnmgr.c
+
+    Usage:
+      bench [-n buttons] [-g group size] [-p pattern] [-t ticks] [-m ms] [-r rate] [-s seed]
+        -n  number of buttons, 1 - 100000 (default 1000)
+        -g  buttons per group, 0 is no group (default 0)
+        -p  idle   : all buttons are released
+            typing : random keys are pressed for 60 - 140ms (default)
+            hold   : all buttons are held, long press and repeat
+            chord  : the buttons of each group are pressed together
+        -t  number of ticks (default 10000)
+        -m  time of a tick, ms (default 5)
+        -r  key presses per second of typing (default 20)
+        -s  seed of the random keys (default 1)
+
+    The buttons are read by input ports of Z_BTNMGR_PORT_WIDTH bits, the
+    ports are read once per tick in the order they are registered.
+--------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 199309L
+#include "../src/z_btnmgr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// DEFINE --------------------------------------------------------------------
+#define BENCH_MAX_BTNS          100000
+#define BENCH_BITS              Z_BTNMGR_PORT_WIDTH
+
+// TYPE ----------------------------------------------------------------------
+typedef enum {
+    BenchPat_Idle = 0,
+    BenchPat_Typing,
+    BenchPat_Hold,
+    BenchPat_Chord,
+}bench_pattern_t;
+
+typedef struct {
+    uint32_t BtnNum;
+    uint32_t GrpSize;
+    bench_pattern_t Pattern;
+    uint32_t Ticks;
+    uint32_t TickMs;
+    uint32_t Rate;
+    uint32_t Seed;
+}bench_cfg_t;
+
+// VLAUE ---------------------------------------------------------------------
+static z_btnmgr_ctx_t bench_Mgr;
+static z_btn_t* bench_Btns = 0;
+static z_btngroup_t* bench_Grps = 0;
+static z_btnport_t* bench_Ports = 0;
+static z_portval_t* bench_Levels = 0;  // level of all buttons, one bit per button
+static uint32_t* bench_ReleaseAt = 0;  // typing : time to release the key, 0 is released
+static uint32_t bench_PortNum = 0;
+static uint32_t bench_PortCursor = 0;
+static uint32_t bench_Random = 1;
+static uint64_t bench_Events[16];
+
+/**-------------------------------------------------------------------
+ * @fn     : bench_random
+ * @brief  : xorshift32, the same keys for the same seed
+ * @param  : none
+ * @return : res   - random value
+ */
+static uint32_t bench_random(void)
+{
+    bench_Random ^= bench_Random << 13;
+    bench_Random ^= bench_Random >> 17;
+    bench_Random ^= bench_Random << 5;
+    return bench_Random;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : bench_nowNs
+ * @brief  : Monotonic time of host
+ * @param  : none
+ * @return : res   - time(ns)
+ */
+static uint64_t bench_nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : bench_readPort
+ * @brief  : Read the next port, the tick reads all ports once by order
+ * @param  : none
+ * @return : res   - levels of the port
+ */
+static z_portval_t bench_readPort(void)
+{
+    z_portval_t res = bench_Levels[bench_PortCursor];
+    bench_PortCursor = bench_PortCursor + 1 < bench_PortNum ? bench_PortCursor + 1 : 0;
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : bench_event
+ * @brief  : Count the events by state
+ * @param  : _args  - event of a button or a group
+ * @return : none
+ */
+static void bench_event(z_btn_args_t _args)
+{
+    bench_Events[_args.State & 0x0F]++;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : bench_setLevel
+ * @brief  : Set the level of a simulated button
+ * @param  : _id     - index of button
+ *           _level  - presing : 1,released : 0
+ * @return : none
+ */
+static void bench_setLevel(uint32_t _id,uint8_t _level)
+{
+    z_portval_t bit = (z_portval_t)1 << (_id % BENCH_BITS);
+    if (_level != 0) {
+        bench_Levels[_id / BENCH_BITS] |= bit;
+    }
+    else {
+        bench_Levels[_id / BENCH_BITS] &= ~bit;
+    }
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : bench_patternProc
+ * @brief  : Change the levels of buttons by the pattern, before a tick
+ * @param  : _cfg   - configuration
+ *           _time  - time of the next tick(ms)
+ * @return : none
+ */
+static void bench_patternProc(const bench_cfg_t* _cfg,uint32_t _time)
+{
+    uint32_t i = 0, n = 0, id = 0;
+    uint32_t grp = _cfg->GrpSize != 0 ? _cfg->GrpSize : 4;
+    switch (_cfg->Pattern) {
+    case BenchPat_Typing: {
+        // presses in this tick, the rest is kept for the next ticks
+        static uint32_t acc = 0;
+        acc += _cfg->Rate * _cfg->TickMs;
+        n = acc / 1000;
+        acc %= 1000;
+        for (i = 0; i < n; i++) {
+            id = bench_random() % _cfg->BtnNum;
+            if (bench_ReleaseAt[id] == 0) {
+                bench_ReleaseAt[id] = _time + 60 + bench_random() % 80;
+                bench_setLevel(id,1);
+            }
+        }
+        for (id = 0; id < _cfg->BtnNum; id++) {
+            if (bench_ReleaseAt[id] != 0 && bench_ReleaseAt[id] <= _time) {
+                bench_ReleaseAt[id] = 0;
+                bench_setLevel(id,0);
+            }
+        }
+    }break;
+    case BenchPat_Hold: {
+        if (_time == _cfg->TickMs) {
+            for (id = 0; id < _cfg->BtnNum; id++) {
+                bench_setLevel(id,1);
+            }
+        }
+    }break;
+    case BenchPat_Chord: {
+        // every 400ms, one chord per group held 150ms, the groups start 50ms apart
+        for (id = 0; id < _cfg->BtnNum; id++) {
+            n = (_time + (id / grp) * 50) % 400;
+            bench_setLevel(id,n < 150);
+        }
+    }break;
+    default:break;
+    }
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : bench_cmp
+ * @brief  : Order of two latencies for qsort
+ */
+static int bench_cmp(const void* _a,const void* _b)
+{
+    uint32_t a = *(const uint32_t*)_a, b = *(const uint32_t*)_b;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : bench_setup
+ * @brief  : Create the buttons, ports and groups
+ * @param  : _cfg   - configuration
+ * @return : res   - 0 when done
+ */
+static int bench_setup(const bench_cfg_t* _cfg)
+{
+    uint32_t i = 0;
+    uint32_t grpnum = _cfg->GrpSize != 0 ? (_cfg->BtnNum + _cfg->GrpSize - 1) / _cfg->GrpSize : 0;
+
+    bench_PortNum = (_cfg->BtnNum + BENCH_BITS - 1) / BENCH_BITS;
+    bench_Btns = calloc(_cfg->BtnNum,sizeof(z_btn_t));
+    bench_Ports = calloc(bench_PortNum,sizeof(z_btnport_t));
+    bench_Levels = calloc(bench_PortNum,sizeof(z_portval_t));
+    bench_ReleaseAt = calloc(_cfg->BtnNum,sizeof(uint32_t));
+    bench_Grps = calloc(grpnum + 1,sizeof(z_btngroup_t));
+    if (bench_Btns == 0 || bench_Ports == 0 || bench_Levels == 0 ||
+        bench_ReleaseAt == 0 || bench_Grps == 0) {
+        return -1;
+    }
+    z_btnmgr_ctxInit(&bench_Mgr);
+    for (i = 0; i < bench_PortNum; i++) {
+        z_btnmgr_ctxRegPort(&bench_Mgr,&bench_Ports[i],bench_readPort);
+    }
+    for (i = 0; i < grpnum; i++) {
+        z_btnmgr_ctxRegGrounp(&bench_Mgr,&bench_Grps[i],bench_event);
+    }
+    for (i = 0; i < _cfg->BtnNum; i++) {
+        if (z_btnmgr_ctxCreatePortBtn(&bench_Mgr,&bench_Btns[i],&bench_Ports[i / BENCH_BITS],
+                                      i % BENCH_BITS,bench_event) != Z_ERR_OK) {
+            return -1;
+        }
+        if (grpnum != 0) {
+            z_btnmgr_setGrounp(&bench_Grps[i / _cfg->GrpSize],&bench_Btns[i]);
+        }
+        else {
+            z_btnmgr_regBtn(&bench_Btns[i]);
+        }
+    }
+    return 0;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : bench_report
+ * @brief  : Print the results
+ * @param  : _cfg     - configuration
+ *           _lat     - time of every tick(ns)
+ *           _total   - time of all ticks(ns)
+ * @return : none
+ */
+static void bench_report(const bench_cfg_t* _cfg,uint32_t* _lat,uint64_t _total)
+{
+    static const char* names[] = {"none","pressing","pressed","releasing","clicked",
+                                  "doubleclicked","longpressing","repeat","tripleclicked"};
+    z_btnqueue_stat_t stat;
+    uint64_t events = 0;
+    uint32_t i = 0;
+    double bytes = 0;
+
+    qsort(_lat,_cfg->Ticks,sizeof(uint32_t),bench_cmp);
+    for (i = 0; i < 16; i++) {
+        events += bench_Events[i];
+    }
+    printf("buttons %u, groups of %u, ticks %u x %u ms, max btns %u\n",
+           _cfg->BtnNum,_cfg->GrpSize,_cfg->Ticks,_cfg->TickMs,(unsigned)Z_BTNMGR_MAX_BTNS);
+    printf("tick ns    : p50 %u  p90 %u  p99 %u  p99.9 %u  max %u  mean %.0f\n",
+           _lat[_cfg->Ticks / 2],_lat[(uint64_t)_cfg->Ticks * 90 / 100],
+           _lat[(uint64_t)_cfg->Ticks * 99 / 100],_lat[(uint64_t)_cfg->Ticks * 999 / 1000],
+           _lat[_cfg->Ticks - 1],(double)_total / _cfg->Ticks);
+    printf("ns/button  : %.2f\n",(double)_total / _cfg->Ticks / _cfg->BtnNum);
+    printf("events     : %llu , %.0f per second of tick\n",(unsigned long long)events,
+           _total != 0 ? events * 1e9 / (double)_total : 0.0);
+    for (i = 1; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (bench_Events[i] != 0) {
+            printf("  %-14s %llu\n",names[i],(unsigned long long)bench_Events[i]);
+        }
+    }
+    z_btnmgr_ctxGetQueueStat(&bench_Mgr,&stat);
+    if (stat.EventLost != 0 || stat.EventPeak != 0) {
+        printf("  queue peak %u , lost %u\n",stat.EventPeak,stat.EventLost);
+    }
+    // button object, its part of the pool, a port and a group
+    bytes = sizeof(z_btn_t) + (double)sizeof(z_btnport_t) / BENCH_BITS;
+#if Z_BTNMGR_MAX_BTNS > 0
+    bytes += (double)sizeof(z_btnpool_t) / Z_BTNMGR_MAX_BTNS;
+#endif
+    if (_cfg->GrpSize != 0) {
+        bytes += (double)sizeof(z_btngroup_t) / _cfg->GrpSize;
+    }
+    printf("memory     : %.1f bytes/button , manager %u bytes\n",bytes,(unsigned)sizeof(z_btnmgr_ctx_t));
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : main
+ * @brief  : none
+ * @param  : none
+ * @return : res   - 0 when done
+ */
+int main(int argc,char** argv)
+{
+    bench_cfg_t cfg = {1000,0,BenchPat_Typing,10000,5,20,1};
+    uint32_t* lat = 0;
+    uint64_t t0 = 0, t1 = 0, total = 0;
+    uint32_t i = 0;
+    int opt = 1;
+
+    for (opt = 1; opt + 1 < argc; opt += 2) {
+        const char* val = argv[opt + 1];
+        switch (argv[opt][1]) {
+        case 'n': cfg.BtnNum = (uint32_t)strtoul(val,0,0); break;
+        case 'g': cfg.GrpSize = (uint32_t)strtoul(val,0,0); break;
+        case 't': cfg.Ticks = (uint32_t)strtoul(val,0,0); break;
+        case 'm': cfg.TickMs = (uint32_t)strtoul(val,0,0); break;
+        case 'r': cfg.Rate = (uint32_t)strtoul(val,0,0); break;
+        case 's': cfg.Seed = (uint32_t)strtoul(val,0,0); break;
+        case 'p': {
+            cfg.Pattern = val[0] == 'i' ? BenchPat_Idle :
+                          val[0] == 'h' ? BenchPat_Hold :
+                          val[0] == 'c' ? BenchPat_Chord : BenchPat_Typing;
+        }break;
+        default:break;
+        }
+    }
+    if (cfg.BtnNum == 0 || cfg.BtnNum > BENCH_MAX_BTNS ||
+        (Z_BTNMGR_MAX_BTNS > 0 && cfg.BtnNum > Z_BTNMGR_MAX_BTNS) ||
+        cfg.Ticks == 0 || cfg.TickMs == 0) {
+        printf("bad options, see the head of bench.c\n");
+        return 1;
+    }
+    bench_Random = cfg.Seed != 0 ? cfg.Seed : 1;
+    lat = calloc(cfg.Ticks,sizeof(uint32_t));
+    if (lat == 0 || bench_setup(&cfg) != 0) {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    for (i = 0; i < cfg.Ticks; i++) {
+        bench_patternProc(&cfg,(i + 1) * cfg.TickMs);
+        t0 = bench_nowNs();
+        z_btnmgr_ctxTick(&bench_Mgr,cfg.TickMs);
+        z_btnmgr_ctxDispatch(&bench_Mgr,0);
+        t1 = bench_nowNs();
+        lat[i] = (uint32_t)(t1 - t0 < 0xFFFFFFFFULL ? t1 - t0 : 0xFFFFFFFFULL);
+        total += t1 - t0;
+    }
+    bench_report(&cfg,lat,total);
+    return 0;
+}
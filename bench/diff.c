@@ -0,0 +1,237 @@
+/*--------------------------------------------------------------------
+@file            : diff.c
+@brief           : Host differential check of the button manager.
+                   Runs 40 buttons with random presses, glitches and
+                   tick lengths, and prints a hash of all events. Every
+                   build of the same options gives the same hash.
+----------------------------------------------------------------------
+@attention       :
+    Build once per mode with the options of the profiles, the acceleration,
+    the edge time and the debounce modes, the hashes of all builds must be
+    the same:
+      F="-DZ_BTNMGR_TIMING_PROFILES=1 -DZ_BTNMGR_REPEAT_ACCEL=1 -DZ_BTNMGR_EDGE_TIME=1 -DZ_BTNMGR_DEBOUNCE_MODES=1"
+      gcc -O2 $F -o diff_list bench/diff.c src/z_btnmgr.c
+      gcc -O2 $F -DZ_BTNMGR_MAX_BTNS=64 -o diff_pool bench/diff.c src/z_btnmgr.c
+      gcc -O2 $F -DZ_BTNMGR_MAX_BTNS=64 -DZ_BTNMGR_WHEEL_BITS=2 -o diff_wheel2 bench/diff.c src/z_btnmgr.c
+      gcc -O2 $F -DZ_BTNMGR_MAX_BTNS=64 -DZ_BTNMGR_WHEEL_BITS=6 -o diff_wheel6 bench/diff.c src/z_btnmgr.c
+      gcc -O2 $F -DZ_BTNMGR_MAX_BTNS=64 -DZ_BTNMGR_COMPACT=1 -o diff_compact bench/diff.c src/z_btnmgr.c
+
+    Usage:
+      diff [-t ticks] [-s seed] [-o start] [-v 1]
+        -t  number of ticks (default 200000)
+        -s  seed of the random keys (default 1)
+        -o  tick count at the start (default 4294901760, the tick count
+            wraps in the run)
+        -v  1 : print each event as a line "tick button state", button
+            is the order of creation, 40 is the group (default 0)
+
+    The buttons have the 3 debounce modes, the 3 types and 4 timing
+    profiles (one with acceleration of the repeat), the ports are read
+    with and without the port debounce, and 4 buttons are in a group.
+    A profile and a debounce mode are changed while the buttons run.
+    The ticks are 1ms, 10ms or 1 - 37ms (late ticks) by phases.
+--------------------------------------------------------------------*/
+#include "../src/z_btnmgr.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if Z_BTNMGR_TIMING_PROFILES == 0 || Z_BTNMGR_REPEAT_ACCEL == 0 || \
+    Z_BTNMGR_EDGE_TIME == 0 || Z_BTNMGR_DEBOUNCE_MODES == 0
+#error "diff.c needs the options of the head of diff.c"
+#endif
+
+// DEFINE --------------------------------------------------------------------
+#define DIFF_BTNS               40
+#define DIFF_PORTS              4
+#define DIFF_GRP_BTNS           4       // the last buttons are in the group
+
+// VLAUE ---------------------------------------------------------------------
+static z_btnmgr_ctx_t diff_Mgr;
+static z_btnport_t diff_Ports[DIFF_PORTS];
+static z_portval_t diff_Levels[DIFF_PORTS];
+static uint8_t diff_PortRead = 0;
+static z_btn_t diff_Btns[DIFF_BTNS];
+static z_btngroup_t diff_Grp;
+static uint32_t diff_Random = 1;
+static uint32_t diff_Start = 0;
+static uint8_t diff_Verbose = 0;
+static uint64_t diff_Events = 0;
+static uint64_t diff_Hash = 14695981039346656037ULL;
+// default, short, accelerated repeat, long press only
+static const z_btntiming_t diff_Timing[4] = {
+    Z_BTNMGR_TIMING_DEFAULT,
+    {10,400,50,150,0,0,0},
+    {30,700,200,250,20,30,0},
+    {5,3000,0,100,0,0,40},
+};
+
+/**-------------------------------------------------------------------
+ * @fn     : diff_rand
+ * @brief  : xorshift32, the same keys on every host
+ * @param  : none
+ * @return : res   - random number
+ */
+static uint32_t diff_rand(void)
+{
+    diff_Random ^= diff_Random << 13;
+    diff_Random ^= diff_Random >> 17;
+    diff_Random ^= diff_Random << 5;
+    return diff_Random;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : diff_readPort
+ * @brief  : Read function of the ports, in the order they are registered
+ * @param  : none
+ * @return : res   - levels of the port
+ */
+static z_portval_t diff_readPort(void)
+{
+    z_portval_t res = diff_Levels[diff_PortRead];
+    diff_PortRead = (uint8_t)((diff_PortRead + 1) % DIFF_PORTS);
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : diff_event
+ * @brief  : Add a event to the hash, the times are from the start,
+ *           the edge time is the delay from it in 16 bits
+ * @param  : _args  - event of a button or the group
+ * @return : none
+ */
+static void diff_event(z_btn_args_t _args)
+{
+    uint32_t id = DIFF_BTNS;
+    uint32_t val[4];
+    uint8_t i = 0;
+#if Z_BTNMGR_MAX_BTNS > 0
+    // the buttons are created in order, the id in the pool is the order
+    if (_args.Id != Z_BTNMGR_ID_NONE) {
+        id = _args.Id;
+    }
+#else
+    if ((const z_btn_t*)_args.Obj >= diff_Btns &&
+        (const z_btn_t*)_args.Obj < diff_Btns + DIFF_BTNS) {
+        id = (uint32_t)((const z_btn_t*)_args.Obj - diff_Btns);
+    }
+#endif
+    val[0] = _args.Time - diff_Start;
+    val[1] = (_args.Time - _args.EdgeTime) & 0xFFFF;   // the compact pool keeps 16 bits
+    val[2] = id;
+    val[3] = (uint32_t)_args.State;
+    for (i = 0; i < 4; i++) {
+        diff_Hash = (diff_Hash ^ val[i]) * 1099511628211ULL;
+    }
+    if (diff_Verbose != 0) {
+        printf("%lu %lu %d\n",(unsigned long)val[0],(unsigned long)id,(int)_args.State);
+    }
+    diff_Events++;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : diff_flip
+ * @brief  : Change the level of a button
+ * @param  : _id   - order of creation
+ * @return : none
+ */
+static void diff_flip(uint32_t _id)
+{
+    diff_Levels[_id % DIFF_PORTS] ^= (z_portval_t)1 << (_id / DIFF_PORTS);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : diff_setup
+ * @brief  : Create the ports, the buttons and the group
+ * @param  : none
+ * @return : res   - 0 when done
+ */
+static int diff_setup(void)
+{
+    uint32_t i = 0;
+    z_btnmgr_ctxInit(&diff_Mgr);
+    z_btnmgr_ctxTickTo(&diff_Mgr,diff_Start);
+    for (i = 0; i < DIFF_PORTS; i++) {
+        z_btnmgr_ctxRegPort(&diff_Mgr,&diff_Ports[i],diff_readPort);
+        z_btnmgr_setPortDebounce(&diff_Ports[i],(uint8_t)(i & 0x01));
+    }
+    z_btnmgr_ctxRegGrounp(&diff_Mgr,&diff_Grp,diff_event);
+    for (i = 0; i < DIFF_BTNS; i++) {
+        if (z_btnmgr_ctxCreatePortBtn(&diff_Mgr,&diff_Btns[i],&diff_Ports[i % DIFF_PORTS],
+                                      (uint8_t)(i / DIFF_PORTS),diff_event) != Z_ERR_OK ||
+            z_btnmgr_setDebounce(&diff_Btns[i],(z_btn_debounce_t)((i / DIFF_PORTS) % 3)) != Z_ERR_OK ||
+            z_btnmgr_setType(&diff_Btns[i],(z_btn_type_t)(BtnType_SingleClicked + i % 3)) != Z_ERR_OK ||
+            z_btnmgr_setTiming(&diff_Btns[i],&diff_Timing[i % 4]) != Z_ERR_OK) {
+            return -1;
+        }
+        if (i >= DIFF_BTNS - DIFF_GRP_BTNS) {
+            z_btnmgr_setGrounp(&diff_Grp,&diff_Btns[i]);
+        }
+        else {
+            z_btnmgr_regBtn(&diff_Btns[i]);
+        }
+    }
+    return 0;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : main
+ * @brief  : none
+ * @param  : none
+ * @return : res   - 0 when done
+ */
+int main(int argc,char** argv)
+{
+    uint32_t ticks = 200000;
+    uint32_t k = 0;
+    uint32_t r = 0;
+    uint32_t id = 0;
+    uint32_t ms = 0;
+    int opt = 1;
+
+    diff_Start = 0xFFFF0000UL;
+    for (opt = 1; opt + 1 < argc; opt += 2) {
+        const char* val = argv[opt + 1];
+        switch (argv[opt][1]) {
+        case 't': ticks = (uint32_t)strtoul(val,0,0); break;
+        case 's': diff_Random = (uint32_t)strtoul(val,0,0); break;
+        case 'o': diff_Start = (uint32_t)strtoul(val,0,0); break;
+        case 'v': diff_Verbose = (uint8_t)strtoul(val,0,0); break;
+        default:break;
+        }
+    }
+    if (ticks == 0 || diff_Random == 0) {
+        printf("bad options, see the head of diff.c\n");
+        return 1;
+    }
+    if (diff_setup() != 0) {
+        printf("setup failed, the options of the build are too small\n");
+        return 1;
+    }
+    for (k = 0; k < ticks; k++) {
+        r = diff_rand() % 100;
+        if (r < 3) {
+            diff_flip(diff_rand() % DIFF_BTNS);
+        }
+        else if (r < 4) {
+            // a glitch of one tick
+            id = diff_rand() % DIFF_BTNS;
+            diff_flip(id);
+            z_btnmgr_ctxTick(&diff_Mgr,1);
+            diff_flip(id);
+        }
+        if (k % 50000 == 0) {
+            z_btnmgr_setTiming(&diff_Btns[5],&diff_Timing[1 + (k / 50000) % 2]);
+        }
+        if (k % 70001 == 0) {
+            z_btnmgr_setDebounce(&diff_Btns[9],(z_btn_debounce_t)((k / 70001) % 3));
+        }
+        switch ((k / 7000) % 4) {
+        case 0: ms = 1 + diff_rand() % 37; break;
+        case 1: ms = 1; break;
+        default: ms = 10; break;
+        }
+        z_btnmgr_ctxTick(&diff_Mgr,ms);
+    }
+    printf("events %llu hash %016llx\n",(unsigned long long)diff_Events,(unsigned long long)diff_Hash);
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*--------------------------------------------------------------------
+@file            : replay.c
+@brief           : Host replay of an input trace.
+                   Runs a trace of z_btnmgr_getTrace through the button
+                   state machines as fast as it can, and prints the events.
+----------------------------------------------------------------------
+@attention       :
+    Build with the same options as the unit that recorded the trace:
+      gcc -O2 -DZ_BTNMGR_TRACE_SIZE=4096 -o replay bench/replay.c src/z_btnmgr.c
+
+    Usage:
+      replay trace.bin > events.txt
+    Each event is a line "tick button state", button is the order of creation.
+
+    The buttons must be created in the same order and with the same type,
+    timing and groups as on the unit: change replay_setup to the setup code
+    of the unit. The default setup is single click buttons with the
+    default timing.
+--------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 199309L
+#include "../src/z_btnmgr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// VLAUE ---------------------------------------------------------------------
+static z_btnmgr_ctx_t replay_Mgr;
+static z_btn_t replay_Btns[Z_BTNMGR_TRACE_BTNS];
+static uint64_t replay_Events = 0;
+
+/**-------------------------------------------------------------------
+ * @fn     : replay_read
+ * @brief  : Read function of all buttons, the level comes from the trace
+ * @param  : none
+ * @return : res   - 0
+ */
+static uint8_t replay_read(void)
+{
+    return 0;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : replay_event
+ * @brief  : Print a event
+ * @param  : _args  - event of a button or a group
+ * @return : none
+ */
+static void replay_event(z_btn_args_t _args)
+{
+    long id = -1;
+#if Z_BTNMGR_MAX_BTNS > 0
+    if (_args.Id != Z_BTNMGR_ID_NONE) {
+        id = (long)_args.Id;
+    }
+#else
+    if ((const z_btn_t*)_args.Obj >= replay_Btns &&
+        (const z_btn_t*)_args.Obj < replay_Btns + Z_BTNMGR_TRACE_BTNS) {
+        id = (long)((const z_btn_t*)_args.Obj - replay_Btns);
+    }
+#endif
+    printf("%lu %ld %d\n",(unsigned long)_args.Time,id,(int)_args.State);
+    replay_Events++;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : replay_setup
+ * @brief  : Create the buttons as the unit did
+ * @param  : none
+ * @return : none
+ */
+static void replay_setup(void)
+{
+    uint32_t i = 0;
+    z_btnmgr_ctxInit(&replay_Mgr);
+    for (i = 0; i < Z_BTNMGR_TRACE_BTNS; i++) {
+        z_btnmgr_ctxCreategBtn(&replay_Mgr,&replay_Btns[i],replay_read,replay_event);
+        z_btnmgr_regBtn(&replay_Btns[i]);
+    }
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : main
+ * @brief  : none
+ * @param  : none
+ * @return : res   - 0 when done
+ */
+int main(int argc,char** argv)
+{
+    FILE* file = 0;
+    uint8_t* trace = 0;
+    long len = 0;
+    struct timespec t0, t1;
+    double sec = 0;
+    z_err_t err = Z_ERR_OK;
+
+    if (argc < 2 || (file = fopen(argv[1],"rb")) == 0) {
+        fprintf(stderr,"usage : replay trace.bin\n");
+        return 1;
+    }
+    fseek(file,0,SEEK_END);
+    len = ftell(file);
+    fseek(file,0,SEEK_SET);
+    trace = malloc(len > 0 ? (size_t)len : 1);
+    if (trace == 0 || fread(trace,1,(size_t)len,file) != (size_t)len) {
+        fprintf(stderr,"can not read %s\n",argv[1]);
+        return 1;
+    }
+    fclose(file);
+
+    replay_setup();
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    err = z_btnmgr_ctxReplay(&replay_Mgr,trace,(uint32_t)len);
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    sec = (double)(t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    if (err != Z_ERR_OK) {
+        fprintf(stderr,"bad trace, error %u\n",(unsigned)err);
+        return 1;
+    }
+    fprintf(stderr,"%ld bytes, %lu ms of input, %llu events in %.3f s\n",len,
+            (unsigned long)z_btnmgr_ctxGetTickCount(&replay_Mgr),
+            (unsigned long long)replay_Events,sec);
+    free(trace);
+    return 0;
+}
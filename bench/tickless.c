@@ -0,0 +1,173 @@
+/*--------------------------------------------------------------------
+@file            : tickless.c
+@brief           : Host check of the tickless loop.
+                   Calls the tick only at z_btnmgr_nextDeadline or at a
+                   pin change, and checks that the port debounce still
+                   takes its samples over time.
+----------------------------------------------------------------------
+@attention       :
+    Build with the options of the target and run it, it prints "ok" and
+    returns 0, or prints the failed case and returns 1:
+      gcc -O2 -o tickless bench/tickless.c src/z_btnmgr.c
+      ./tickless
+
+    The cases are:
+      glitch  - a pin pressed for 1ms is rejected by the port debounce
+      bounce  - a press after 4 bounces of 1ms is reported once, after
+                the last bounce
+      ghost   - 3 keys of a matrix held with a ghost key, the loop does
+                not tick again without time passing
+--------------------------------------------------------------------*/
+#include "../src/z_btnmgr.h"
+#include <stdio.h>
+
+// DEFINE --------------------------------------------------------------------
+#define TICKLESS_ZERO_TICKS     8       // ticks in a row without time, a busy loop
+#define TICKLESS_MS(_MS_)       ((uint32_t)(_MS_) * Z_BTNMGR_CLOCK_PER_MS)
+
+// VLAUE ---------------------------------------------------------------------
+static z_btnmgr_ctx_t tickless_Mgr;
+static z_btnport_t tickless_Port;
+static z_btnmatrix_t tickless_Matrix;
+static z_btnport_t tickless_Rows[2];
+static z_btn_t tickless_Btns[5];          // the pin, and the keys of the matrix
+static z_portval_t tickless_Level = 0;
+static z_portval_t tickless_Keys[2] = {0,0};
+static uint8_t tickless_Row = 0;
+static uint32_t tickless_Now = 0;
+static uint32_t tickless_Events = 0;
+static uint32_t tickless_FirstEvent = 0;
+
+/**-------------------------------------------------------------------
+ * @fn     : tickless_readPort
+ * @brief  : Read function of the port, bit 0 is the pin
+ * @param  : none
+ * @return : res   - levels of the port
+ */
+static z_portval_t tickless_readPort(void)
+{
+    return tickless_Level;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : tickless_selectRow
+ * @brief  : Select a row of the matrix
+ * @param  : _row  - row
+ * @return : none
+ */
+static void tickless_selectRow(uint8_t _row)
+{
+    tickless_Row = _row;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : tickless_readCols
+ * @brief  : Columns of the selected row, 1 is pressed
+ * @param  : none
+ * @return : res   - levels of the columns
+ */
+static z_portval_t tickless_readCols(void)
+{
+    return tickless_Keys[tickless_Row];
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : tickless_event
+ * @brief  : Count the events
+ * @param  : _args  - event of a button
+ * @return : none
+ */
+static void tickless_event(z_btn_args_t _args)
+{
+    if (tickless_Events == 0) {
+        tickless_FirstEvent = _args.Time;
+    }
+    tickless_Events++;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : tickless_run
+ * @brief  : Run the tickless loop until _end, the pin toggles at the
+ *           times of _edges and wakes the loop up
+ * @param  : _edges - times of the pin changes, in order
+ *           _num   - number of edges
+ *           _end   - time to stop
+ * @return : res   - 0 when done, 1 on a busy loop
+ */
+static int tickless_run(const uint32_t* _edges,uint8_t _num,uint32_t _end)
+{
+    uint32_t next = 0;
+    uint32_t target = 0;
+    uint32_t zero = 0;
+    uint8_t edge = 0;
+
+    while (tickless_Now < _end) {
+        next = z_btnmgr_ctxNextDeadline(&tickless_Mgr);
+        target = (next == Z_BTNMGR_DEADLINE_NONE || next > _end - tickless_Now) ? _end : tickless_Now + next;
+        // a pin change wakes it up before the deadline
+        if (edge < _num && _edges[edge] < target) {
+            target = _edges[edge];
+        }
+        while (edge < _num && _edges[edge] <= target) {
+            tickless_Level ^= 0x01;
+            edge++;
+        }
+        zero = (target == tickless_Now) ? zero + 1 : 0;
+        if (zero > TICKLESS_ZERO_TICKS) {
+            return 1;
+        }
+        z_btnmgr_ctxTick(&tickless_Mgr,target - tickless_Now);
+        z_btnmgr_ctxDispatch(&tickless_Mgr,0xFFFF);
+        tickless_Now = target;
+    }
+    return 0;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : main
+ * @brief  : none
+ * @param  : none
+ * @return : res   - 0 when all cases pass
+ */
+int main(void)
+{
+    static const uint32_t glitch[] = {TICKLESS_MS(100),TICKLESS_MS(101)};
+    static const uint32_t bounce[] = {TICKLESS_MS(1000),TICKLESS_MS(1001),TICKLESS_MS(1002),
+                                      TICKLESS_MS(1003),TICKLESS_MS(1004),TICKLESS_MS(1200)};
+    uint8_t i = 0;
+
+    z_btnmgr_ctxInit(&tickless_Mgr);
+    z_btnmgr_ctxRegPort(&tickless_Mgr,&tickless_Port,tickless_readPort);
+    z_btnmgr_setPortDebounce(&tickless_Port,1);
+    z_btnmgr_ctxCreatePortBtn(&tickless_Mgr,&tickless_Btns[0],&tickless_Port,0,tickless_event);
+    z_btnmgr_regBtn(&tickless_Btns[0]);
+
+    if (tickless_run(glitch,2,TICKLESS_MS(900)) != 0 || tickless_Events != 0) {
+        printf("glitch: %lu events, the 1ms press must be rejected\n",(unsigned long)tickless_Events);
+        return 1;
+    }
+    if (tickless_run(bounce,6,TICKLESS_MS(3000)) != 0 || tickless_Events == 0 ||
+        tickless_FirstEvent < TICKLESS_MS(1004 + 3 * Z_BTNMGR_SAMPLE_MS)) {
+        printf("bounce: %lu events, first at %lu\n",(unsigned long)tickless_Events,
+               (unsigned long)tickless_FirstEvent);
+        return 1;
+    }
+
+    // keys (0,0) (0,1) (1,0) held, row 1 reads the ghost (1,1) too
+    z_btnmgr_ctxRegMatrix(&tickless_Mgr,&tickless_Matrix,tickless_Rows,2,tickless_selectRow,tickless_readCols);
+    for (i = 0; i < 4; i++) {
+        z_btnmgr_ctxCreateMatrixBtn(&tickless_Mgr,&tickless_Btns[1 + i],&tickless_Matrix,
+                                    (uint8_t)(i / 2),(uint8_t)(i % 2),tickless_event);
+        z_btnmgr_regBtn(&tickless_Btns[1 + i]);
+    }
+    tickless_Keys[0] = 0x03;
+    tickless_Keys[1] = 0x03;
+    z_btnmgr_ctxTick(&tickless_Mgr,TICKLESS_MS(1));
+    tickless_Now += TICKLESS_MS(1);
+    if (tickless_Matrix.GhostRows == 0 || tickless_run(0,0,tickless_Now + TICKLESS_MS(500)) != 0) {
+        printf("ghost: the loop ticks again without time passing\n");
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
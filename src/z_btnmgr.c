@@ -24,54 +24,452 @@
 
 #if  __BUTTON_MARGER_ENABLE__ == 1
 // DEFINE --------------------------------------------------------------------
+#if Z_BTNMGR_EDGE_QUEUE_SIZE > 0
+#if (Z_BTNMGR_EDGE_QUEUE_SIZE & (Z_BTNMGR_EDGE_QUEUE_SIZE - 1)) != 0
+#error "Z_BTNMGR_EDGE_QUEUE_SIZE must be a power of 2"
+#endif
+#define Z_BTNMGR_EDGE_QUEUE_MASK    (Z_BTNMGR_EDGE_QUEUE_SIZE - 1)
+#endif
+#if Z_BTNMGR_EVENT_QUEUE_SIZE > 0
+#if (Z_BTNMGR_EVENT_QUEUE_SIZE & (Z_BTNMGR_EVENT_QUEUE_SIZE - 1)) != 0
+#error "Z_BTNMGR_EVENT_QUEUE_SIZE must be a power of 2"
+#endif
+#define Z_BTNMGR_EVENT_QUEUE_MASK   (Z_BTNMGR_EVENT_QUEUE_SIZE - 1)
+#endif
+#if Z_BTNMGR_TRACE_SIZE > 0
+/* Head of trace data given by z_btnmgr_getTrace : "ZT" , version */
+#define Z_BTNMGR_TRACE_MAGIC0       'Z'
+#define Z_BTNMGR_TRACE_MAGIC1       'T'
+#define Z_BTNMGR_TRACE_VERSION      1
+#define __TRACE_BIT(_MAP_,_ID_)     (((_MAP_)[(_ID_) >> 5] >> ((_ID_) & 0x1F)) & 0x01)
+#define __TRACE_FLIP(_MAP_,_ID_)    ((_MAP_)[(_ID_) >> 5] ^= (1UL << ((_ID_) & 0x1F)))
+#endif
+
+/* Field of a button, by the reference of button */
+#if Z_BTNMGR_MAX_BTNS > 0
+#define __BTN(_REF_,_FIELD_)        (_ctx->Pool._FIELD_[_REF_])
+#define __HBTN(_BTN_,_FIELD_)       (__BTNMGR(_BTN_)->Pool._FIELD_[(_BTN_)->Id])
+#define __BTNREF(_BTN_)             ((_BTN_)->Id)
+#define __BTNID(_REF_)              (_REF_)
+#if Z_BTNMGR_POOL_OBJ > 0
+#define __BTNOBJ(_REF_)             (_ctx->Pool.Obj[_REF_])
+#else
+#define __BTNOBJ(_REF_)             ((const z_btn_t*)0)
+#endif
+#define __BTNARGID(_REF_)           (_REF_)
+#define __BTNREF_NONE               0xFFFF
+#else
+#define __BTN(_REF_,_FIELD_)        ((_REF_)->_FIELD_)
+#define __HBTN(_BTN_,_FIELD_)       ((_BTN_)->_FIELD_)
+#define __BTNREF(_BTN_)             (_BTN_)
+#define __BTNID(_REF_)              ((_REF_)->Id)
+#define __BTNOBJ(_REF_)             (_REF_)
+#define __BTNARGID(_REF_)           Z_BTNMGR_ID_NONE
+#define __BTNREF_NONE               0
+#endif
+/* Id of the compact pool for a port bit of many buttons, they are found by the port and the bit */
+#define __BTNREF_MANY               0xFFFE
+/* __BTN reads the manager _ctx, __HBTN reads the manager of the button object */
+
+/* Read callback, event, port and timing profile of a button */
+#if Z_BTNMGR_COMPACT > 0
+#define __BTNREAD(_REF_)            (_ctx->SharedRead[_ctx->Pool.ClickAction[_REF_]])
+#define __BTNEVENT(_REF_)           (_ctx->SharedEvent[_ctx->Pool.Event[_REF_]])
+#define __BTNPORT(_REF_)            (_ctx->SharedPort[_ctx->Pool.Port[_REF_]])
+#else
+#define __BTNREAD(_REF_)            __BTN(_REF_,ClickAction)
+#define __BTNEVENT(_REF_)           __BTN(_REF_,Event)
+#define __BTNPORT(_REF_)            __BTN(_REF_,Port)
+#endif
+#if Z_BTNMGR_TIMING_PROFILES == 0
+#define __BTNTIMING(_REF_)          (&z_btnmgr_DefaultTiming)
+#elif Z_BTNMGR_COMPACT > 0
+#define __BTNTIMING(_REF_)          (_ctx->SharedTiming[_ctx->Pool.Timing[_REF_]])
+#else
+#define __BTNTIMING(_REF_)          __BTN(_REF_,Timing)
+#endif
+
+/* Time of a button (StartPresseTime, PressTimeBuf, StartReleaseTime) as a tick count */
+#if Z_BTNMGR_COMPACT > 0
+/* the tick count of 16 bits time, in 32768ms before or after now */
+#define __TIME16(_VAL_)             (_ctx->TickCount + (uint32_t)(int32_t)(int16_t)(uint16_t)((_VAL_) - (uint16_t)_ctx->TickCount))
+#define __BTNTIME(_REF_,_FIELD_)    __TIME16(_ctx->Pool._FIELD_[_REF_])
+/* the tick count of 16 bits time that is not after now, in 65535ms before now */
+#define __TIME16PAST(_VAL_)         (_ctx->TickCount - (uint16_t)((uint16_t)_ctx->TickCount - (_VAL_)))
+#define __BTNPASTTIME(_REF_,_FIELD_) __TIME16PAST(_ctx->Pool._FIELD_[_REF_])
+#else
+#define __BTNTIME(_REF_,_FIELD_)    __BTN(_REF_,_FIELD_)
+#define __BTNPASTTIME(_REF_,_FIELD_) __BTN(_REF_,_FIELD_)
+#endif
+#define __BTNSETTIME(_REF_,_FIELD_,_VAL_) (__BTN(_REF_,_FIELD_) = (z_btntime_t)(_VAL_))
+
+/* StartPresseTime and StartReleaseTime are times while their flag is set,
+   no tick count is kept as "not set" */
+#define __BTNSTART(_REF_,_FIELD_)   do { \
+            __BTNSETTIME(_REF_,_FIELD_,_ctx->TickCount); \
+            __BTN(_REF_,Flags)._FIELD_##Set = 1; \
+        } while (0)
+#define __BTNSTOP(_REF_,_FIELD_)    (__BTN(_REF_,Flags)._FIELD_##Set = 0)
+#define __BTNSTARTED(_REF_,_FIELD_) (__BTN(_REF_,Flags)._FIELD_##Set)
+
+/* Time from a tick count to now, right while it is less than 2^31,
+   also when the tick count wraps */
+#define __TIME_SINCE(_TIME_)        ((uint32_t)(_ctx->TickCount - (uint32_t)(_TIME_)))
+/* A tick count is now or before now */
+#define __TIME_DUE(_TIME_)          (__TIME_SINCE(_TIME_) < 0x80000000UL)
+/* A tick count is after another one */
+#define __TIME_AFTER(_A_,_B_)       ((int32_t)((uint32_t)(_A_) - (uint32_t)(_B_)) > 0)
+/* Ticks of the clock of a time in ms */
+#define __MS(_MS_)                  ((uint32_t)(_MS_) * (uint32_t)Z_BTNMGR_CLOCK_PER_MS)
+
+#if Z_BTNMGR_COMPACT > 0
+/* Index of a value in a table of the compact pool, the value is added
+   when it is new, 0 for the value 0 or when the table is full */
+#define __SHARED_INDEX(_TABLE_,_VAL_,_RES_) do { \
+            uint16_t index_buf = 0; \
+            (_RES_) = 0; \
+            for (index_buf = 1; (_VAL_) != 0 && index_buf < Z_BTNMGR_COMPACT_SHARED; index_buf++) { \
+                if ((_TABLE_)[index_buf] == (_VAL_) || (_TABLE_)[index_buf] == 0) { \
+                    (_TABLE_)[index_buf] = (_VAL_); \
+                    (_RES_) = (uint8_t)index_buf; \
+                    break; \
+                } \
+            } \
+        } while (0)
+#endif
+
+/* Button manager of a created button object */
+#if Z_BTNMGR_COMPACT > 0
+#define __BTNMGR(_BTN_)             (z_btnmgr_Mgrs[(_BTN_)->Mgr])
+#else
+#define __BTNMGR(_BTN_)             ((_BTN_)->Ctx)
+#endif
+/* Button manager of a button object, 0 before it is created */
+#define __BTNCTX(_BTN_)             ((_BTN_) != 0 ? __BTNMGR(_BTN_) : 0)
+
+#if Z_BTNMGR_CHORD_BTNS > 0
+/* Key set of chords, one bit per button id */
+#define __CHORD_BIT(_MAP_,_ID_)     (((_MAP_)[(_ID_) >> 5] >> ((_ID_) & 0x1F)) & 0x01)
+#define __CHORD_FLIP(_MAP_,_ID_)    ((_MAP_)[(_ID_) >> 5] ^= (1UL << ((_ID_) & 0x1F)))
+#endif
+
+#if Z_BTNMGR_SEQ_NODES > 0
+/* Slot of a event in the symbol hash of the key sequences */
+#define __SEQ_HASH(_OBJ_,_STA_)     ((uint8_t)((((uintptr_t)(_OBJ_) >> 2) ^ ((uintptr_t)(_STA_) * 0x9E37U)) & \
+                                               (Z_BTNMGR_SEQ_SYMS * 2 - 1)))
+#define __SEQ_SYM_NONE              0xFF
+#endif
+
+#if Z_BTNMGR_MAX_BTNS > 0
+/* Active set of the pool, one bit per button id */
+#define __POOL_SETACTIVE(_CTX_,_ID_) ((_CTX_)->Pool.Active[(_ID_) >> 5] |= (1UL << ((_ID_) & 0x1F)))
+#endif
+
+#if Z_BTNMGR_WHEEL_BITS > 0
+#define __WHEEL_MASK                (Z_BTNMGR_WHEEL_SLOTS - 1)
+#define __WHEEL_NONE                0xFF
+/* Empty a slot of the wheel */
+#define __WHEEL_CLEAR(_CTX_,_SLOT_) do { \
+            (_CTX_)->Wheel[_SLOT_] = __BTNREF_NONE; \
+            (_CTX_)->WheelBits[(_SLOT_) >> 5] &= ~(1UL << ((_SLOT_) & 0x1F)); \
+        } while (0)
+#endif
 
 // TYPE ----------------------------------------------------------------------
 
-// All global variable definitions for this file
-typedef struct{
-    z_blist_t Btns_BListHead;      // The list head of a button
-    z_blist_t BtnGrounp_BListHead; // The list head of a button group collection
-    uint32_t TickCount;
-}z_btnmgr_params_t;
+#if Z_BTNMGR_MAX_BTNS > 0
+// Reference of a button, the id in the pool
+typedef uint16_t z_btnref_t;
+#else
+// Reference of a button, the button object
+typedef z_btn_t* z_btnref_t;
+#endif
 
 // FUNCTION ------------------------------------------------------------------
-void z_btnmgr_btnProc(z_btn_t* _btn);
-void z_btnmgr_groupProc(z_btngroup_t* _group);
+void z_btnmgr_btnProc(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn);
+void z_btnmgr_groupProc(z_btnmgr_ctx_t* _ctx,z_btngroup_t* _group);
+#if Z_BTNMGR_MAX_BTNS > 0
+static void __poolWakePort(z_btnmgr_ctx_t* _ctx,z_btnport_t* _port);
+static void __poolActiveProc(z_btnmgr_ctx_t* _ctx);
+#endif
+#if Z_BTNMGR_WHEEL_BITS > 0
+static void __wheelProc(z_btnmgr_ctx_t* _ctx);
+static uint32_t __btnDeadline(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn);
+#endif
+#if Z_BTNMGR_CHORD_BTNS > 0
+static void __chordProc(z_btnmgr_ctx_t* _ctx);
+#endif
+#if Z_BTNMGR_SEQ_NODES > 0
+static z_err_t __seqBuild(z_btnmgr_ctx_t* _ctx);
+#endif
+#if Z_BTNMGR_BATCH_SIZE > 0 && Z_BTNMGR_EVENT_QUEUE_SIZE == 0
+static void __batchFlush(z_btnmgr_ctx_t* _ctx,uint8_t _end);
+#endif
 
 
 // VLAUE ---------------------------------------------------------------------
-static z_btnmgr_params_t  z_btnmgr_Params = {0};
-static z_btnmgr_params_t *const base = &z_btnmgr_Params;
+// button manager of the functions without a z_btnmgr_ctx_t
+static z_btnmgr_ctx_t  z_btnmgr_Default = {0};
+static z_btnmgr_ctx_t *const base = &z_btnmgr_Default;
+#if Z_BTNMGR_COMPACT > 0
+// managers of the button handles by index, the first is none
+static z_btnmgr_ctx_t* z_btnmgr_Mgrs[Z_BTNMGR_COMPACT_MGRS + 1] = {0};
+#endif
+// timing profile of the buttons that have not set one
+static const z_btntiming_t z_btnmgr_DefaultTiming = Z_BTNMGR_TIMING_DEFAULT;
 
 /**-------------------------------------------------------------------
- * @fn     : z_btnmgr_init
+ * @fn     : __btnHasInput
+ * @brief  : Returns whether the button has a input to read the level
+ * @param  : _ctx  - a button manager
+ *           _btn  - point of button object.
+ * @return : res  - ture when it has a input
+ */
+static inline uint8_t __btnHasInput(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    uint8_t res = false;
+    (void)_ctx;
+    if (__BTN(_btn,ClickAction) != 0 || __BTN(_btn,Port) != 0 || __BTN(_btn,Flags).Edge == 1) {
+        res = true;
+    }
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnIsValid
+ * @brief  : Returns whether the button object has been created
+ * @param  : _ctx  - a button manager
+ *           _btn  - point of button object.
+ * @return : res  - ture when it is valid
+ */
+static inline uint8_t __btnIsValid(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn)
+{
+    uint8_t res = false;
+    if (_ctx == 0 || _btn == 0) {
+        goto error;
+    }
+#if Z_BTNMGR_POOL_OBJ > 0 && Z_BTNMGR_MAX_BTNS > 0
+    if (_btn->Id >= _ctx->Pool.Count || _ctx->Pool.Obj[_btn->Id] != _btn) {
+        goto error;
+    }
+#elif Z_BTNMGR_MAX_BTNS > 0
+    // a copy of the handle is the same button
+    if (_btn->Id >= _ctx->Pool.Count || _btn->Mgr != _ctx->Mgr) {
+        goto error;
+    }
+#endif
+    res = true;
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnAlloc
+ * @brief  : Give a button object its id in the pool,a object that
+ *           already has one keeps it
+ * @param  : _ctx  - a button manager
+ *           _btn  - point of button object.
+ * @return : res  - error status
+ */
+static z_err_t __btnAlloc(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn)
+{
+    z_err_t res = Z_ERR_OK;
+    if (_ctx == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+#if Z_BTNMGR_MAX_BTNS > 0
+    uint16_t id = 0;
+    z_btnport_t* port_p = 0;
+    if (__btnIsValid(_ctx,_btn) == true) {
+        // created again, it may leave its port bit
+        port_p = __BTNPORT(_btn->Id);
+        if (port_p != 0) {
+            port_p->BitBtn[_ctx->Pool.PortBit[_btn->Id]] = __BTNREF_NONE;
+        }
+        _ctx->PortBtnsChanged = true;
+        goto error;
+    }
+    if (_ctx->Pool.Count >= Z_BTNMGR_MAX_BTNS) {
+        res = Z_ERR_OVERRANGE;
+        goto error;
+    }
+#if Z_BTNMGR_COMPACT > 0
+    // more managers than Z_BTNMGR_COMPACT_MGRS
+    if (_ctx->Mgr == 0) {
+        res = Z_ERR_OVERRANGE;
+        goto error;
+    }
+#endif
+    id = _ctx->Pool.Count++;
+    _btn->Id = id;
+#if Z_BTNMGR_POOL_OBJ > 0
+    _ctx->Pool.Obj[id] = _btn;
+#endif
+    _ctx->Pool.StartPresseTime[id] = 0;
+    _ctx->Pool.PressTimeBuf[id] = 0;
+    _ctx->Pool.StartReleaseTime[id] = 0;
+#if Z_BTNMGR_EDGE_TIME > 0
+    _ctx->Pool.EdgeTime[id] = 0;
+#endif
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+    _ctx->Pool.FilterTime[id] = 0;
+#endif
+    _ctx->Pool.State[id] = BtnSta_None;
+    memset(&_ctx->Pool.Flags[id],0,sizeof(z_btnflags_t));
+#if Z_BTNMGR_WHEEL_BITS > 0
+    _ctx->Pool.WheelSlot[id] = __WHEEL_NONE;
+#endif
+#elif Z_BTNMGR_TRACE_SIZE > 0 || Z_BTNMGR_CHORD_BTNS > 0
+    _btn->Id = _ctx->BtnIds++;
+#endif
+#if Z_BTNMGR_COMPACT > 0
+    _btn->Mgr = _ctx->Mgr;
+#else
+    _btn->Ctx = _ctx;
+#endif
+    __HBTN(_btn,Flags).StartPresseTimeSet = 0;
+    __HBTN(_btn,Flags).StartReleaseTimeSet = 0;
+    __HBTN(_btn,Flags).Pressed = 0;
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+    __HBTN(_btn,Flags).Filter = 0;
+    __HBTN(_btn,Flags).Hold = 0;
+    __HBTN(_btn,DebounceMode) = BtnDebounce_Deferred;
+    __HBTN(_btn,FilterSum) = 0;
+#endif
+    __HBTN(_btn,EventMask) = Z_BTNMGR_EVENT_ALL;
+#if Z_BTNMGR_STATS > 0
+    __HBTN(_btn,LatencyMax) = 0;
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnSetShared
+ * @brief  : Set the read callback, event, port and timing profile of a
+ *           button.In the compact pool they are kept once in the tables
+ *           of the manager, and the button has their index.
+ * @param  : _ctx     - a button manager
+ *           _btn     - a Button object
+ *           _read    - callback function that reads button state, or 0.
+ *           _event   - callback function of event, or 0.
+ *           _port    - input port, or 0.
+ *           _timing  - timing profile.
+ * @return : res  - error status, Z_ERR_OVERRANGE when a table is full
+ */
+static z_err_t __btnSetShared(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn,z_readbtn_cb _read,z_click_event _event,
+                              z_btnport_t* _port,const z_btntiming_t* _timing)
+{
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_COMPACT > 0
+    uint8_t read = 0;
+    uint8_t event = 0;
+    uint8_t port = 0;
+    uint8_t timing = 1;
+    __SHARED_INDEX(_ctx->SharedRead,_read,read);
+    __SHARED_INDEX(_ctx->SharedEvent,_event,event);
+    __SHARED_INDEX(_ctx->SharedPort,_port,port);
+#if Z_BTNMGR_TIMING_PROFILES > 0
+    __SHARED_INDEX(_ctx->SharedTiming,_timing,timing);
+#else
+    (void)_timing;
+#endif
+    if ((_read != 0 && read == 0) || (_event != 0 && event == 0) ||
+        (_port != 0 && port == 0) || timing == 0) {
+        res = Z_ERR_OVERRANGE;
+    }
+    else {
+        __BTN(_btn,ClickAction) = read;
+        __BTN(_btn,Event) = event;
+        __BTN(_btn,Port) = port;
+#if Z_BTNMGR_TIMING_PROFILES > 0
+        __BTN(_btn,Timing) = timing;
+#endif
+    }
+#else
+    (void)_ctx;
+    __BTN(_btn,ClickAction) = _read;
+    __BTN(_btn,Event) = _event;
+    __BTN(_btn,Port) = _port;
+#if Z_BTNMGR_TIMING_PROFILES > 0
+    __BTN(_btn,Timing) = _timing;
+#else
+    (void)_timing;
+#endif
+#endif
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxInit
  * @brief  : Initialization function
- * @param  : none
+ * @param  : _ctx  - a button manager
  * @return : none
  */
-void z_btnmgr_init(void)
+void z_btnmgr_ctxInit(z_btnmgr_ctx_t* _ctx)
 {
-    LIST_INIT(&base->Btns_BListHead);
-    LIST_INIT(&base->BtnGrounp_BListHead);
+#if Z_BTNMGR_COMPACT > 0
+    uint8_t i = 0;
+#endif
+    memset(_ctx,0,sizeof(z_btnmgr_ctx_t));
+    LIST_INIT(&_ctx->Btns_BListHead);
+    LIST_INIT(&_ctx->BtnGrounp_BListHead);
+    LIST_INIT(&_ctx->Ports_BListHead);
+    LIST_INIT(&_ctx->Matrix_BListHead);
+    LIST_INIT(&_ctx->Ladder_BListHead);
+    LIST_INIT(&_ctx->Shift_BListHead);
+#if Z_BTNMGR_CHORD_BTNS > 0
+    LIST_INIT(&_ctx->Chord_BListHead);
+#endif
+#if Z_BTNMGR_SEQ_NODES > 0
+    LIST_INIT(&_ctx->Seq_BListHead);
+#endif
+#if Z_BTNMGR_WHEEL_BITS > 0
+    memset(_ctx->Wheel,0xFF,sizeof(_ctx->Wheel));
+#endif
+#if Z_BTNMGR_COMPACT > 0
+    // the index of a manager initialized again is kept
+    for (i = 1; i <= Z_BTNMGR_COMPACT_MGRS; i++) {
+        if (z_btnmgr_Mgrs[i] == _ctx || z_btnmgr_Mgrs[i] == 0) {
+            z_btnmgr_Mgrs[i] = _ctx;
+            _ctx->Mgr = i;
+            break;
+        }
+    }
+#endif
 }
 
 /**-------------------------------------------------------------------
- * @fn     : z_btnmgr_creategBtn
+ * @fn     : z_btnmgr_ctxCreategBtn
  * @brief  : Create a button object
- * @param  : _btn      - point of button object.
+ * @param  : _ctx      - a button manager
+ *           _btn      - point of button object.
  *           _readbtn  - callback function that reads button state.
  *           _event    - callback function that button status update event.
  * @return : res  - error status
  */
-z_err_t z_btnmgr_creategBtn(z_btn_t* _btn,z_readbtn_cb _readbtn, z_click_event _event)
+z_err_t z_btnmgr_ctxCreategBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_readbtn_cb _readbtn, z_click_event _event)
 {
     z_err_t res = Z_ERR_OK;
     if (_btn == 0 || _readbtn == 0) {
         res = Z_ERR_BADPARAM;
         goto error;
     }
-    _btn->ClickAction = _readbtn;
-    _btn->Event = _event;
+    res = __btnAlloc(_ctx,_btn);
+    if (res != Z_ERR_OK) {
+        goto error;
+    }
+    res = __btnSetShared(_ctx,__BTNREF(_btn),_readbtn,_event,0,&z_btnmgr_DefaultTiming);
+    if (res != Z_ERR_OK) {
+        goto error;
+    }
+    __HBTN(_btn,PortBit) = 0;
+    __HBTN(_btn,Type) = BtnType_SingleClicked;
+    __HBTN(_btn,Clicks) = 0;
+    __HBTN(_btn,Flags).Edge = 0;
 
 error:
     return res;
@@ -86,315 +484,2864 @@ error:
 z_err_t z_btnmgr_regBtn(z_btn_t* _btn)
 {
     z_err_t res = Z_ERR_OK;
-    if (_btn == 0 || _btn->ClickAction == 0) {
+    if (__btnIsValid(__BTNCTX(_btn),_btn) == false || __btnHasInput(__BTNMGR(_btn),__BTNREF(_btn)) == false) {
         res = Z_ERR_BADPARAM;
         goto error;
     }
     
+#if Z_BTNMGR_MAX_BTNS > 0
+    __HBTN(_btn,Flags).Reg = 1;
+    __BTNMGR(_btn)->PortBtnsChanged = true;
+    __POOL_SETACTIVE(__BTNMGR(_btn),_btn->Id);
+#else
     LIST_INIT(&_btn->List);
-    LIST_ADD(&_btn->List,&base->Btns_BListHead);
+    LIST_ADD(&_btn->List,&__BTNMGR(_btn)->Btns_BListHead);
+#endif
 error:
     return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : z_btnmgr_regGrounp
- * @brief  : Register a button group in the button manager
- * @param  : _group      - point of button group.
- *           _event      - callback function that button group status update event.
+ * @fn     : __portInit
+ * @brief  : Clear the sample and debounce state of a input port
+ * @param  : _ctx   - a button manager
+ *           _port  - point of input port.
+ * @return : none
+ */
+static void __portInit(z_btnmgr_ctx_t* _ctx,z_btnport_t* _port)
+{
+    _port->Raw = 0;
+    _port->Value = 0;
+    _port->Changed = 0;
+    _port->Cnt0 = 0;
+    _port->Cnt1 = 0;
+    _port->Flags.Debounce = 0;
+#if Z_BTNMGR_MAX_BTNS > 0
+    // the buttons that already use the port are put again in the next tick
+    memset(_port->BitBtn,0xFF,sizeof(_port->BitBtn));
+    _ctx->PortBtnsChanged = true;
+#else
+    (void)_ctx;
+#endif
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxRegPort
+ * @brief  : Register a input port in the button manager.
+ *           The port is read once per tick, and all of its buttons
+ *           use the same sample.
+ * @param  : _ctx       - a button manager
+ *           _port      - point of input port.
+ *           _readport  - callback function that reads all bits of the port.
  * @return : res  - error status
  */
-z_err_t z_btnmgr_regGrounp(z_btngroup_t* _group, z_click_event _event)
+z_err_t z_btnmgr_ctxRegPort(z_btnmgr_ctx_t* _ctx,z_btnport_t* _port,z_readport_cb _readport)
 {
     z_err_t res = Z_ERR_OK;
-    if (_group == 0) {
+    if (_port == 0 || _readport == 0) {
         res = Z_ERR_BADPARAM;
         goto error;
     }
-    _group->Event = _event;
-    LIST_INIT(&_group->List);
-    LIST_INIT(&_group->BtnsList);
-    LIST_ADD(&_group->List,&base->BtnGrounp_BListHead);
+    __portInit(_ctx,_port);
+    _port->ReadPort = _readport;
+    LIST_INIT(&_port->List);
+    LIST_ADD(&_port->List,&_ctx->Ports_BListHead);
 
 error:
     return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : z_btnmgr_setGrounp
- * @brief  : Adds a button object to a button group
- * @param  : _group  - point of button group.
- *           _btn    - point of button object.
+ * @fn     : z_btnmgr_setPortDebounce
+ * @brief  : Enable the vertical counter debounce of a input port.
+ *           A bit of the port changes after 4 continuous equal samples,
+ *           all bits are processed together, so the buttons of this port
+ *           skip the time debounce of each button.
+ * @param  : _port    - point of input port.
+ *           _enable  - 1 : enable , 0 : disable
  * @return : res  - error status
  */
-z_err_t z_btnmgr_setGrounp(z_btngroup_t* _group, z_btn_t* _btn)
+z_err_t z_btnmgr_setPortDebounce(z_btnport_t* _port,uint8_t _enable)
 {
     z_err_t res = Z_ERR_OK;
-    if (_group == 0 || _btn == 0) {
+    if (_port == 0) {
         res = Z_ERR_BADPARAM;
         goto error;
     }
-    LIST_INIT(&_btn->List);
-    LIST_ADD(&_btn->List, &_group->BtnsList);
-
-    if (_btn->Event == 0) {
-        _btn->Event = _group->Event;
-    }
+    _port->Cnt0 = 0;
+    _port->Cnt1 = 0;
+    _port->Flags.Debounce = _enable == 0 ? 0 : 1;
 
 error:
     return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : z_btnmgr_setGrpProperty
- * @brief  : Set button group properties
- * @param  : _group      - point of button group.
- *           _val        - sets the properties between keys in the press and button combination.
+ * @fn     : z_btnmgr_ctxCreatePortBtn
+ * @brief  : Create a button object that reads one bit of a input port
+ * @param  : _ctx      - a button manager
+ *           _btn      - point of button object.
+ *           _port     - point of input port.
+ *           _bit      - bit index of the button in the port.
+ *           _event    - callback function that button status update event.
  * @return : res  - error status
  */
-z_err_t z_btnmgr_setGrpProperty(z_btngroup_t* _group, z_btngrp_property _val)
+z_err_t z_btnmgr_ctxCreatePortBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_btnport_t* _port,uint8_t _bit,z_click_event _event)
 {
     z_err_t res = Z_ERR_OK;
-    if (_group == 0) {
+    if (_btn == 0 || _port == 0) {
         res = Z_ERR_BADPARAM;
         goto error;
     }
-    if (_val == BrnGrpProp_None) {
-        _group->Property = BrnGrpProp_Parallel;
+    if (_bit >= Z_BTNMGR_PORT_WIDTH) {
+        res = Z_ERR_OVERRANGE;
+        goto error;
     }
-    else {
-        _group->Property = _val;
+    res = __btnAlloc(_ctx,_btn);
+    if (res != Z_ERR_OK) {
+        goto error;
     }
-
+    res = __btnSetShared(_ctx,__BTNREF(_btn),0,_event,_port,&z_btnmgr_DefaultTiming);
+    if (res != Z_ERR_OK) {
+        goto error;
+    }
+    __HBTN(_btn,PortBit) = _bit;
+    __HBTN(_btn,Type) = BtnType_SingleClicked;
+    __HBTN(_btn,Clicks) = 0;
+    __HBTN(_btn,Flags).Edge = 0;
 
 error:
     return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : z_btnmgr_isPressing
- * @brief  : Returns whether the button is pressed
- * @param  : _btn  - point of button object.
- * @return : res  - ture when button is pressing
- *                - false that button is not pressing
+ * @fn     : z_btnmgr_ctxCreateEdgeBtn
+ * @brief  : Create a button object whose level is only given by
+ *           z_btnmgr_pushEdge,it is never read in the tick.
+ * @param  : _ctx      - a button manager
+ *           _btn      - point of button object.
+ *           _level    - level of button now.
+ *           _event    - callback function that button status update event.
+ * @return : res  - error status
  */
-uint8_t z_btnmgr_isPressing(z_btn_t* _btn)
+z_err_t z_btnmgr_ctxCreateEdgeBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,uint8_t _level,z_click_event _event)
 {
-    uint8_t res = false;
-    if (_btn->State == BtnSta_Pressing ||
-        _btn->State == BtnSta_LongPressing) {
-        res = true;
+    z_err_t res = Z_ERR_OK;
+    if (_btn == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    res = __btnAlloc(_ctx,_btn);
+    if (res != Z_ERR_OK) {
+        goto error;
     }
+    res = __btnSetShared(_ctx,__BTNREF(_btn),0,_event,0,&z_btnmgr_DefaultTiming);
+    if (res != Z_ERR_OK) {
+        goto error;
+    }
+    __HBTN(_btn,PortBit) = 0;
+    __HBTN(_btn,Type) = BtnType_SingleClicked;
+    __HBTN(_btn,Clicks) = 0;
+    __HBTN(_btn,Flags).Edge = 1;
+    __HBTN(_btn,Flags).Level = _level == 0 ? 0 : 1;
 
+error:
     return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : z_btnmgr_wasPressed
- * @brief  : Returns whether the button has been pressed
- * @param  : _btn  - point of button object.
- * @return : res  - ture when button was pressed
- *                - false that button was not pressed
+ * @fn     : z_btnmgr_pushEdge
+ * @brief  : Record a level change of a edge button, it can be called in a
+ *           interrupt.The edges are handled by order in the next tick,
+ *           at the time of each edge.
+ *           Only one interrupt (or task) may push, and only one task may
+ *           call z_btnmgr_tick.
+ * @param  : _btn      - point of button object.
+ *           _level    - new level of button,presing : 1,released : 0
+ *           _time     - time of the edge,in the time of z_btnmgr_getTickCount
+ * @return : res  - error status
  */
-uint8_t z_btnmgr_wasPressed(z_btn_t* _btn)
+z_err_t z_btnmgr_pushEdge(z_btn_t* _btn,uint8_t _level,uint32_t _time)
 {
-    uint8_t res = false;
-    if (_btn->PreState == BtnSta_Pressed) {
-        _btn->PreState = BtnSta_None;
-        res = true;
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_EDGE_QUEUE_SIZE > 0
+    z_btnmgr_ctx_t* ctx_p = __BTNCTX(_btn);
+    uint16_t head = 0;
+    uint16_t next = 0;
+#if Z_BTNMGR_STATS > 0
+    uint32_t cycles = Z_BTNMGR_CYCLES();
+#endif
+    if (ctx_p == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
     }
+    head = ctx_p->EdgeHead;
+    next = (head + 1) & Z_BTNMGR_EDGE_QUEUE_MASK;
+    if (next == ctx_p->EdgeTail) {
+        ctx_p->EdgeLost++;
+        res = Z_ERR_OVERRANGE;
+        goto error;
+    }
+    ctx_p->EdgeQueue[head].Btn = _btn;
+    ctx_p->EdgeQueue[head].Time = _time;
+    ctx_p->EdgeQueue[head].Level = _level == 0 ? 0 : 1;
+    Z_BTNMGR_BARRIER();
+    ctx_p->EdgeHead = next;
+#if Z_BTNMGR_STATS > 0
+    cycles = Z_BTNMGR_CYCLES() - cycles;
+    if (cycles > ctx_p->Stats.EdgeMax) {
+        ctx_p->Stats.EdgeMax = cycles;
+    }
+#endif
+#else
+    (void)_btn;
+    (void)_level;
+    (void)_time;
+    res = Z_ERR_FAILD;
+    goto error;
+#endif
 
+error:
     return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : z_btnmgr_isReleasing
- * @brief  : Returns whether the button is released
- * @param  : _btn  - point of button object.
- * @return : res  - ture when button is prleasing
- *                - false that button is not prleasing
+ * @fn     : z_btnmgr_ctxGetTickCount
+ * @brief  : Returns the time of the button manager, the sum of the time
+ *           given to z_btnmgr_tick, or the clock of z_btnmgr_tickTo
+ * @param  : _ctx  - a button manager
+ * @return : res  - time(ticks of the clock)
  */
-uint8_t z_btnmgr_isReleasing(z_btn_t* _btn)
+uint32_t z_btnmgr_ctxGetTickCount(z_btnmgr_ctx_t* _ctx)
 {
-    uint8_t res = false;
-    if (_btn->State == BtnSta_Releasing) {
-        res = true;
-    }
-
-    return res;
+    return _ctx->TickCount;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : z_btnmgr_tick
- * @brief  : Cycle and operation
- * @param  : _ms  The recommended time interval for each call is 1-10ms
+ * @fn     : z_btnmgr_ctxRegMatrix
+ * @brief  : Register a key matrix in the button manager.
+ *           The matrix is scanned once per tick, row by row, and every
+ *           row is kept as a input port of columns.
+ * @param  : _ctx       - a button manager
+ *           _matrix    - point of key matrix.
+ *           _rows      - ports buffer of rows, it has _rownum members.
+ *           _rownum    - number of rows, 1-32.
+ *           _driverow  - callback function that selects a row.
+ *           _readcols  - callback function that reads all columns of the selected row.
  * @return : res  - error status
  */
-inline void z_btnmgr_tick(uint32_t _ms)
+z_err_t z_btnmgr_ctxRegMatrix(z_btnmgr_ctx_t* _ctx,z_btnmatrix_t* _matrix,z_btnport_t* _rows,uint8_t _rownum,
+                           z_driverow_cb _driverow,z_readport_cb _readcols)
 {
-
     z_err_t res = Z_ERR_OK;
-    z_blist_t *blist_pbuf = &base->Btns_BListHead;
-    z_btn_t* btn_p = 0;
-    z_btngroup_t* group_p = 0;
-
-    base->TickCount += _ms;
-    // One Button
-    while (blist_pbuf->NextNode != &base->Btns_BListHead)
-    {
-        btn_p = LIST_FIRST_ENTRY(blist_pbuf,
-                                  z_btn_t*,
-                                  List);
-        z_btnmgr_btnProc(btn_p);
-        blist_pbuf = blist_pbuf->NextNode;
+    uint8_t i = 0;
+    if (_matrix == 0 || _rows == 0 || _driverow == 0 || _readcols == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
     }
-    // Button Group
-    blist_pbuf = &base->BtnGrounp_BListHead;
-    while (blist_pbuf->NextNode != &base->BtnGrounp_BListHead)
-    {
-        group_p = LIST_FIRST_ENTRY(blist_pbuf,
-                                   z_btngroup_t*,
-                                   List);
-        // todo
-        z_btnmgr_groupProc(group_p);
-        blist_pbuf = blist_pbuf->NextNode;
+    if (_rownum == 0 || _rownum > 32) {
+        res = Z_ERR_OVERRANGE;
+        goto error;
     }
-    
+    for (i = 0; i < _rownum; i++) {
+        __portInit(_ctx,&_rows[i]);
+        _rows[i].ReadPort = 0;
+        LIST_INIT(&_rows[i].List);
+    }
+    _matrix->DriveRow = _driverow;
+    _matrix->ReadCols = _readcols;
+    _matrix->Rows = _rows;
+    _matrix->RowNum = _rownum;
+    _matrix->GhostRows = 0;
+    LIST_INIT(&_matrix->List);
+    LIST_ADD(&_matrix->List,&_ctx->Matrix_BListHead);
+
+error:
+    return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : __btnReleasingProc
- * @brief  : Event handling of button release status
- * @param  : _btn  - a Button object
- *           _sta  - status of button
+ * @fn     : z_btnmgr_setMatrixDebounce
+ * @brief  : Enable the vertical counter debounce of all rows of a key matrix
+ * @param  : _matrix  - point of key matrix.
+ *           _enable  - 1 : enable , 0 : disable
  * @return : res  - error status
  */
-static inline void __btnCallEventProc(z_btn_t* _btn,z_btn_state_t _sta)
+z_err_t z_btnmgr_setMatrixDebounce(z_btnmatrix_t* _matrix,uint8_t _enable)
 {
-    z_btn_args_t args;
-    if (_btn == 0 || _btn->Event == 0 || _btn->Flags.NoResp == 1) {
+    z_err_t res = Z_ERR_OK;
+    uint8_t i = 0;
+    if (_matrix == 0 || _matrix->Rows == 0) {
+        res = Z_ERR_BADPARAM;
         goto error;
     }
-    args.Obj = _btn;
-    args.State = _sta;
-    _btn->Event(args);
+    for (i = 0; i < _matrix->RowNum; i++) {
+        z_btnmgr_setPortDebounce(&_matrix->Rows[i],_enable);
+    }
 
 error:
-    return;
+    return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : __btnReleasingProc
- * @brief  : Event handling of button release status
- * @param  : _btn  - a Button object
- * @return : res   - state of button
+ * @fn     : z_btnmgr_ctxCreateMatrixBtn
+ * @brief  : Create a button object of a key in matrix
+ * @param  : _ctx      - a button manager
+ *           _btn      - point of button object.
+ *           _matrix   - point of key matrix.
+ *           _row      - row of the key.
+ *           _col      - column of the key.
+ *           _event    - callback function that button status update event.
+ * @return : res  - error status
  */
-static inline z_btn_state_t __btnReleasingProc(z_btn_t* _btn)
+z_err_t z_btnmgr_ctxCreateMatrixBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_btnmatrix_t* _matrix,uint8_t _row,uint8_t _col,z_click_event _event)
 {
-    z_btn_state_t res = BtnSta_Releasing;
-    if (_btn == 0 || _btn->ClickAction == 0) {
-        goto error;
-    }
-    if (_btn->ClickAction() == 0) {
+    z_err_t res = Z_ERR_OK;
+    if (_matrix == 0 || _matrix->Rows == 0) {
+        res = Z_ERR_BADPARAM;
         goto error;
     }
-    if (_btn->StartPresseTime == 0) {
-        _btn->StartPresseTime = base->TickCount;
-    }
-    if (_btn->StartPresseTime + Z_BTNMGR_SHORTTIME_ACTIVE > base->TickCount + 1) {
+    if (_row >= _matrix->RowNum) {
+        res = Z_ERR_OVERRANGE;
         goto error;
     }
-    if (_btn->ClickAction() == 1) {
-        _btn->StartReleaseTime = 0;
-        _btn->PressTimeBuf = base->TickCount;
-        res = BtnSta_Pressing;
-        __btnCallEventProc(_btn,res);
-    }
+    res = z_btnmgr_ctxCreatePortBtn(_ctx,_btn,&_matrix->Rows[_row],_col,_event);
+
 error:
     return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : __btnPressingProc
- * @brief  : Event handling of button press state
- * @param  : _btn  - a Button object
- * @return : res   - state of button
+ * @fn     : z_btnmgr_ctxRegLadder
+ * @brief  : Register a resistor ladder in the button manager.
+ *           The ADC is read once per tick, the sample is decoded to the
+ *           nearest level by binary search, and the buttons of the level
+ *           are kept as a input port.
+ * @param  : _ctx         - a button manager
+ *           _ladder      - point of resistor ladder.
+ *           _readadc     - callback function that reads the ADC once.
+ *           _levels      - levels of the ladder, sorted by Value from the
+ *                          lowest, kept by the ladder.
+ *           _levelnum    - number of levels, 2-255.
+ *           _hysteresis  - ADC counts a sample must be past the middle of
+ *                          two levels to change the level, less than half
+ *                          of the gap of levels.
+ * @return : res  - error status
  */
-static inline z_btn_state_t __btnPressingProc(z_btn_t* _btn)
+z_err_t z_btnmgr_ctxRegLadder(z_btnmgr_ctx_t* _ctx,z_btnladder_t* _ladder,z_readadc_cb _readadc,
+                              const z_btnlevel_t* _levels,uint8_t _levelnum,uint16_t _hysteresis)
 {
-    z_btn_state_t res = BtnSta_Pressing;
-    if (_btn == 0 || _btn->ClickAction == 0) {
+    z_err_t res = Z_ERR_OK;
+    uint8_t i = 0;
+    if (_ladder == 0 || _readadc == 0 || _levels == 0) {
+        res = Z_ERR_BADPARAM;
         goto error;
     }
-    // Button release detected
-    if (_btn->ClickAction() == 0) {
-        if (_btn->StartReleaseTime == 0) {
-            _btn->StartReleaseTime = base->TickCount;
-        }
-        else if (_btn->StartReleaseTime + Z_BTNMGR_SHORTTIME_ACTIVE < base->TickCount + 1) {
-            _btn->StartReleaseTime = 0;
-            res = BtnSta_Clicked;
-            __btnCallEventProc(_btn,res);
+    if (_levelnum < 2) {
+        res = Z_ERR_OVERRANGE;
+        goto error;
+    }
+    for (i = 1; i < _levelnum; i++) {
+        if (_levels[i].Value <= _levels[i - 1].Value ||
+            (uint32_t)(_levels[i].Value - _levels[i - 1].Value) <= 2 * (uint32_t)_hysteresis) {
+            res = Z_ERR_OVERRANGE;
             goto error;
         }
     }
-    else if (_btn->StartReleaseTime + Z_BTNMGR_SHORTTIME_ACTIVE < base->TickCount + 1) {
-        _btn->StartReleaseTime = 0;
-    }
-    // btn is Keep pressing
-    if (_btn->StartPresseTime == 0) {
-        _btn->StartPresseTime = base->TickCount;
-    }
-    if (_btn->StartPresseTime + Z_BTNMGR_LONGTIME_ACTIVE < base->TickCount + 1) {
-        _btn->StartReleaseTime = 0;
-        res = BtnSta_LongPressing;
-        __btnCallEventProc(_btn,res);
-        goto error;
-    }
-    else if ((base->TickCount - _btn->PressTimeBuf) > Z_BTNMGR_SHORTTIME_ACTIVE + 1) {
-        _btn->PressTimeBuf = base->TickCount;
-        __btnCallEventProc(_btn,res);
+    __portInit(_ctx,&_ladder->Port);
+    _ladder->Port.ReadPort = 0;
+    LIST_INIT(&_ladder->Port.List);
+    _ladder->ReadAdc = _readadc;
+    _ladder->Levels = _levels;
+    _ladder->LevelNum = _levelnum;
+    _ladder->Hysteresis = _hysteresis;
+    // start at the level of all released
+    _ladder->Level = 0;
+    for (i = 0; i < _levelnum; i++) {
+        if (_levels[i].Btns == 0) {
+            _ladder->Level = i;
+            break;
+        }
     }
-    
+    LIST_INIT(&_ladder->List);
+    LIST_ADD(&_ladder->List,&_ctx->Ladder_BListHead);
+
 error:
     return res;
 }
 
 /**-------------------------------------------------------------------
- * @fn     : __btnLongPressingProc
- * @brief  : Handling the event that the button is pressed for a long time
- * @param  : _btn  - a Button object
- * @return : res   - state of button
+ * @fn     : z_btnmgr_ctxCreateLadderBtn
+ * @brief  : Create a button object of a resistor ladder
+ * @param  : _ctx      - a button manager
+ *           _btn      - point of button object.
+ *           _ladder   - point of resistor ladder.
+ *           _bit      - bit of the button in the Btns of the levels.
+ *           _event    - callback function that button status update event.
+ * @return : res  - error status
  */
-static inline z_btn_state_t __btnLongPressingProc(z_btn_t* _btn)
+z_err_t z_btnmgr_ctxCreateLadderBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_btnladder_t* _ladder,uint8_t _bit,z_click_event _event)
 {
-    z_btn_state_t res = BtnSta_LongPressing;
-    if (_btn == 0 || _btn->ClickAction == 0) {
+    z_err_t res = Z_ERR_OK;
+    if (_ladder == 0 || _ladder->Levels == 0) {
+        res = Z_ERR_BADPARAM;
         goto error;
     }
-    // button release detected
-    if (_btn->ClickAction() == 0) {
-        if (_btn->StartReleaseTime == 0) {
-            _btn->StartReleaseTime = base->TickCount;
-        }
-        else if (_btn->StartReleaseTime + Z_BTNMGR_SHORTTIME_ACTIVE < base->TickCount + 1) {
-            _btn->StartReleaseTime = 0;
-            res = BtnSta_Pressed;
-            __btnCallEventProc(_btn,res);
-            goto error;
-        }
-    }
-    else if (_btn->StartReleaseTime + Z_BTNMGR_SHORTTIME_ACTIVE < base->TickCount + 1) {
-        _btn->StartReleaseTime = 0;
-    }
-    // btn is Keep pressing
-    if (_btn->StartPresseTime == 0) {
-        _btn->StartPresseTime = base->TickCount;
-    }
-    else if (((base->TickCount - _btn->StartPresseTime - Z_BTNMGR_LONGTIME_ACTIVE) % Z_BTNMGR_LONGTIME_PEER) == 0) {
-        __btnCallEventProc(_btn, BtnSta_LongPressed_Repeat);
-    }
-    
+    res = z_btnmgr_ctxCreatePortBtn(_ctx,_btn,&_ladder->Port,_bit,_event);
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxRegShift
+ * @brief  : Register a chain of shift registers in the button manager.
+ *           The chain is read once per tick by one call of _readbytes
+ *           (a SPI / DMA transfer or bit-bang), and the bytes are kept
+ *           as input ports, Z_BTNMGR_PORT_WIDTH bits per port.
+ *           With DMA, _readbytes may start the next transfer to _buf and
+ *           return at once, the tick then uses the transfer before.
+ * @param  : _ctx        - a button manager
+ *           _shift      - point of shift register chain.
+ *           _ports      - ports buffer, Z_BTNMGR_SHIFT_PORTS(_len) members.
+ *           _buf        - bytes buffer of the transfer, _len members.
+ *           _len        - number of bytes (registers) of the chain, 1 or more.
+ *           _readbytes  - callback function that reads the chain.
+ *           _invert     - a bit is 0 when the button is pressing (pull-up).
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_ctxRegShift(z_btnmgr_ctx_t* _ctx,z_btnshift_t* _shift,z_btnport_t* _ports,uint8_t* _buf,uint16_t _len,
+                             z_readbytes_cb _readbytes,uint8_t _invert)
+{
+    z_err_t res = Z_ERR_OK;
+    uint16_t i = 0;
+    if (_shift == 0 || _ports == 0 || _buf == 0 || _readbytes == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    if (_len == 0 || _len > 0x1FFF) {
+        res = Z_ERR_OVERRANGE;
+        goto error;
+    }
+    for (i = 0; i < Z_BTNMGR_SHIFT_PORTS(_len); i++) {
+        __portInit(_ctx,&_ports[i]);
+        _ports[i].ReadPort = 0;
+        LIST_INIT(&_ports[i].List);
+    }
+    memset(_buf,_invert != 0 ? 0xFF : 0x00,_len);
+    _shift->ReadBytes = _readbytes;
+    _shift->Buf = _buf;
+    _shift->Len = _len;
+    _shift->Invert = _invert != 0 ? 1 : 0;
+    _shift->Ports = _ports;
+    LIST_INIT(&_shift->List);
+    LIST_ADD(&_shift->List,&_ctx->Shift_BListHead);
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setShiftDebounce
+ * @brief  : Enable the vertical counter debounce of all ports of a
+ *           shift register chain
+ * @param  : _shift   - point of shift register chain.
+ *           _enable  - 1 : enable , 0 : disable
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setShiftDebounce(z_btnshift_t* _shift,uint8_t _enable)
+{
+    z_err_t res = Z_ERR_OK;
+    uint16_t i = 0;
+    if (_shift == 0 || _shift->Ports == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    for (i = 0; i < Z_BTNMGR_SHIFT_PORTS(_shift->Len); i++) {
+        z_btnmgr_setPortDebounce(&_shift->Ports[i],_enable);
+    }
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxCreateShiftBtn
+ * @brief  : Create a button object of a shift register chain
+ * @param  : _ctx      - a button manager
+ *           _btn      - point of button object.
+ *           _shift    - point of shift register chain.
+ *           _bit      - bit of the button in the chain, bit 0 of the
+ *                       first byte is 0.
+ *           _event    - callback function that button status update event.
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_ctxCreateShiftBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_btnshift_t* _shift,uint16_t _bit,z_click_event _event)
+{
+    z_err_t res = Z_ERR_OK;
+    if (_shift == 0 || _shift->Ports == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    if (_bit >= _shift->Len * 8) {
+        res = Z_ERR_OVERRANGE;
+        goto error;
+    }
+    res = z_btnmgr_ctxCreatePortBtn(_ctx,_btn,&_shift->Ports[_bit / Z_BTNMGR_PORT_WIDTH],
+                                    _bit % Z_BTNMGR_PORT_WIDTH,_event);
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxRegGrounp
+ * @brief  : Register a button group in the button manager
+ * @param  : _ctx        - a button manager
+ *           _group      - point of button group.
+ *           _event      - callback function that button group status update event.
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_ctxRegGrounp(z_btnmgr_ctx_t* _ctx,z_btngroup_t* _group, z_click_event _event)
+{
+    z_err_t res = Z_ERR_OK;
+    if (_group == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    _group->Event = _event;
+    LIST_INIT(&_group->List);
+#if Z_BTNMGR_COMPACT > 0
+    _group->Ctx = _ctx;
+    memset(_group->Btns,0,sizeof(_group->Btns));
+#elif Z_BTNMGR_MAX_BTNS > 0
+    _group->Ctx = _ctx;
+    _group->BtnsHead = __BTNREF_NONE;
+#else
+    LIST_INIT(&_group->BtnsList);
+#endif
+    LIST_ADD(&_group->List,&_ctx->BtnGrounp_BListHead);
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setGrounp
+ * @brief  : Adds a button object to a button group
+ * @param  : _group  - point of button group.
+ *           _btn    - point of button object.
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setGrounp(z_btngroup_t* _group, z_btn_t* _btn)
+{
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_MAX_BTNS > 0 && Z_BTNMGR_COMPACT == 0
+    uint16_t id = 0;
+#endif
+    if (_group == 0 || __btnIsValid(__BTNCTX(_btn),_btn) == false) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+#if Z_BTNMGR_MAX_BTNS > 0
+    // the ids are of the pool of the group's manager
+    if (__BTNMGR(_btn) != _group->Ctx) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+#if Z_BTNMGR_COMPACT > 0
+    _group->Btns[_btn->Id >> 5] |= 1UL << (_btn->Id & 0x1F);
+#else
+    id = _group->BtnsHead;
+    while (id != __BTNREF_NONE && id != _btn->Id) {
+        id = _group->Ctx->Pool.GroupNext[id];
+    }
+    if (id == __BTNREF_NONE) {
+        __HBTN(_btn,GroupNext) = _group->BtnsHead;
+        _group->BtnsHead = _btn->Id;
+    }
+#endif
+    __HBTN(_btn,Flags).Reg = 1;
+    __BTNMGR(_btn)->PortBtnsChanged = true;
+    __POOL_SETACTIVE(__BTNMGR(_btn),_btn->Id);
+#else
+    LIST_INIT(&_btn->List);
+    LIST_ADD(&_btn->List, &_group->BtnsList);
+#endif
+
+    if (__HBTN(_btn,Event) == 0) {
+#if Z_BTNMGR_COMPACT > 0
+        __SHARED_INDEX(__BTNMGR(_btn)->SharedEvent,_group->Event,__HBTN(_btn,Event));
+        if (_group->Event != 0 && __HBTN(_btn,Event) == 0) {
+            res = Z_ERR_OVERRANGE;
+        }
+#else
+        __HBTN(_btn,Event) = _group->Event;
+#endif
+    }
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setGrpProperty
+ * @brief  : Set button group properties
+ * @param  : _group      - point of button group.
+ *           _val        - sets the properties between keys in the press and button combination.
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setGrpProperty(z_btngroup_t* _group, z_btngrp_property _val)
+{
+    z_err_t res = Z_ERR_OK;
+    if (_group == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    if (_val == BrnGrpProp_None) {
+        _group->Property = BrnGrpProp_Parallel;
+    }
+    else {
+        _group->Property = _val;
+    }
+
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxRegChord
+ * @brief  : Register a chord, it is pressing when its keys are pressing
+ *           by its mode (ChordMode_All by default).
+ *           The keys are buttons of the manager, registered by
+ *           z_btnmgr_regBtn, a button can be a key of many chords.
+ * @param  : _ctx        - a button manager
+ *           _chord      - point of chord.
+ *           _event      - callback function of the chord,
+ *                         BtnSta_Pressing   : the keys are matched
+ *                         BtnSta_Clicked    : the keys are not matched anymore
+ *                         BtnSta_Releasing  : all keys are released
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_ctxRegChord(z_btnmgr_ctx_t* _ctx,z_btnchord_t* _chord,z_click_event _event)
+{
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_CHORD_BTNS > 0
+    if (_ctx == 0 || _chord == 0 || _event == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    memset(_chord,0,sizeof(z_btnchord_t));
+    _chord->Event = _event;
+    _chord->Ctx = _ctx;
+    _chord->State = BtnSta_Releasing;
+    _chord->Property = BrnGrpProp_Parallel;
+    _chord->Mode = ChordMode_All;
+    LIST_INIT(&_chord->List);
+    LIST_ADD(&_chord->List,&_ctx->Chord_BListHead);
+#else
+    (void)_ctx;
+    (void)_chord;
+    (void)_event;
+    res = Z_ERR_FAILD;
+    goto error;
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setChordKey
+ * @brief  : Adds a button to the keys of a chord
+ * @param  : _chord  - point of chord.
+ *           _btn    - point of button object, of the manager of the chord
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setChordKey(z_btnchord_t* _chord,z_btn_t* _btn)
+{
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_CHORD_BTNS > 0
+    uint16_t id = 0;
+    if (_chord == 0 || _chord->Ctx == 0 || __BTNCTX(_btn) != _chord->Ctx ||
+        __btnIsValid(_chord->Ctx,_btn) == false) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    id = _btn->Id;
+    if (id >= Z_BTNMGR_CHORD_BTNS) {
+        res = Z_ERR_OVERRANGE;
+        goto error;
+    }
+    if (__CHORD_BIT(_chord->Keys,id) == 0) {
+        __CHORD_FLIP(_chord->Keys,id);
+        _chord->Ctx->ChordChanged = true;
+    }
+#else
+    (void)_chord;
+    (void)_btn;
+    res = Z_ERR_FAILD;
+    goto error;
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setChordMode
+ * @brief  : Set how the keys of a chord are matched
+ * @param  : _chord  - point of chord.
+ *           _mode   - ChordMode_All   : all keys, other keys do not matter
+ *                     ChordMode_Exact : all keys and no other key
+ *                     ChordMode_Any   : at least _need keys
+ *           _need   - ChordMode_Any : number of keys, 1 or more
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setChordMode(z_btnchord_t* _chord,z_chord_mode_t _mode,uint8_t _need)
+{
+    z_err_t res = Z_ERR_OK;
+    if (_chord == 0 || _mode > ChordMode_Any || (_mode == ChordMode_Any && _need == 0)) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    _chord->Mode = (uint8_t)_mode;
+    _chord->Need = _need;
+#if Z_BTNMGR_CHORD_BTNS > 0
+    if (_chord->Ctx != 0) {
+        _chord->Ctx->ChordChanged = true;
+    }
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setChordProperty
+ * @brief  : Set chord properties
+ * @param  : _chord  - point of chord.
+ *           _val    - BrnGrpProp_Parallel : the keys still give their events
+ *                     BrnGrpProp_Mutex    : the keys give no event from the
+ *                                           match of the chord to the release
+ *                                           of all its keys
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setChordProperty(z_btnchord_t* _chord,z_btngrp_property _val)
+{
+    z_err_t res = Z_ERR_OK;
+    if (_chord == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    if (_val == BrnGrpProp_None) {
+        _chord->Property = BrnGrpProp_Parallel;
+    }
+    else {
+        _chord->Property = _val;
+    }
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxRegSeq
+ * @brief  : Register a key sequence, its event is BtnSta_Clicked when
+ *           the events of its steps happened in order, each one in the
+ *           window of time after the step before.
+ *           The events that are not a step of any sequence are skipped,
+ *           the steps can be events of buttons, groups and chords.
+ *           All sequences of a manager are compiled into one automaton,
+ *           so a event costs one lookup whatever the number of sequences.
+ * @param  : _ctx    - a button manager
+ *           _seq    - point of key sequence.
+ *           _steps  - steps of the sequence, kept by the sequence,
+ *                     the window of the first step is not used
+ *           _num    - number of steps
+ *           _event  - callback function of the sequence
+ * @return : res  - error status, Z_ERR_OVERRANGE when the automaton
+ *                  is full (Z_BTNMGR_SEQ_NODES , Z_BTNMGR_SEQ_SYMS)
+ */
+z_err_t z_btnmgr_ctxRegSeq(z_btnmgr_ctx_t* _ctx,z_btnseq_t* _seq,const z_btnstep_t* _steps,uint8_t _num,
+                           z_click_event _event)
+{
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_SEQ_NODES > 0
+    uint8_t i = 0;
+    if (_ctx == 0 || _seq == 0 || _steps == 0 || _num == 0 || _event == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    for (i = 0; i < _num; i++) {
+        if (_steps[i].Obj == 0 || _steps[i].Obj == _seq) {
+            res = Z_ERR_BADPARAM;
+            goto error;
+        }
+    }
+    _seq->Steps = _steps;
+    _seq->Num = _num;
+    _seq->Event = _event;
+    LIST_INIT(&_seq->List);
+    LIST_ADD(&_seq->List,&_ctx->Seq_BListHead);
+    res = __seqBuild(_ctx);
+    if (res != Z_ERR_OK) {
+        // back to the automaton of the other sequences
+        LIST_DEL(&_seq->List);
+        __seqBuild(_ctx);
+    }
+#else
+    (void)_ctx;
+    (void)_seq;
+    (void)_steps;
+    (void)_num;
+    (void)_event;
+    res = Z_ERR_FAILD;
+    goto error;
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setType
+ * @brief  : Set the kind of clicks that a button reports.
+ *           BtnType_SingleClicked : BtnSta_Clicked at each release,
+ *                                   no waiting (default).
+ *           BtnType_DoubleClicked : BtnSta_DoubleClicked at the release of
+ *                                   the second click, BtnSta_Clicked when no
+ *                                   second click comes in the DoubleClick time.
+ *           BtnType_BothClicked   : BtnSta_Clicked at the first release, then
+ *                                   BtnSta_DoubleClicked and BtnSta_TripleClicked
+ *                                   at the next releases, no waiting.
+ * @param  : _btn   - point of button object.
+ *           _prop  - type of button.
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setType(z_btn_t* _btn,z_btn_type_t _prop)
+{
+    z_err_t res = Z_ERR_OK;
+    if (__btnIsValid(__BTNCTX(_btn),_btn) == false) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    switch (_prop) {
+    case BtnType_SingleClicked:
+    case BtnType_DoubleClicked:
+    case BtnType_BothClicked: {
+        __HBTN(_btn,Type) = (uint8_t)_prop;
+        __HBTN(_btn,Clicks) = 0;
+#if Z_BTNMGR_WHEEL_BITS > 0
+        // the time it waits in the wheel may change
+        __POOL_SETACTIVE(__BTNMGR(_btn),_btn->Id);
+#endif
+    }break;
+    default:res = Z_ERR_BADPARAM;break;
+    }
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setTiming
+ * @brief  : Set the timing profile of a button.The profile is not copied,
+ *           it can be shared by many buttons and changed at any time.
+ * @param  : _btn     - point of button object.
+ *           _timing  - point of timing profile, 0 is the default profile
+ *                      (Z_BTNMGR_TIMING_DEFAULT).
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setTiming(z_btn_t* _btn,const z_btntiming_t* _timing)
+{
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_TIMING_PROFILES > 0
+#if Z_BTNMGR_COMPACT > 0
+    uint8_t timing = 0;
+#endif
+    if (__btnIsValid(__BTNCTX(_btn),_btn) == false) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    if (_timing == 0) {
+        _timing = &z_btnmgr_DefaultTiming;
+    }
+#if Z_BTNMGR_COMPACT > 0
+    __SHARED_INDEX(__BTNMGR(_btn)->SharedTiming,_timing,timing);
+    if (timing == 0) {
+        res = Z_ERR_OVERRANGE;
+        goto error;
+    }
+    __HBTN(_btn,Timing) = timing;
+#else
+    __HBTN(_btn,Timing) = _timing;
+#endif
+    // a held button repeats by the new profile from now
+    if (__HBTN(_btn,State) == BtnSta_LongPressing) {
+#if Z_BTNMGR_REPEAT_ACCEL > 0
+        __HBTN(_btn,RepeatPeriod) = _timing->Repeat;
+#endif
+        __HBTN(_btn,PressTimeBuf) = (z_btntime_t)(__BTNMGR(_btn)->TickCount + __MS(_timing->Repeat));
+    }
+#if Z_BTNMGR_WHEEL_BITS > 0
+    // the time it waits in the wheel may change
+    __POOL_SETACTIVE(__BTNMGR(_btn),_btn->Id);
+#endif
+#else
+    (void)_btn;
+    (void)_timing;
+    res = Z_ERR_FAILD;
+    goto error;
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setEventMask
+ * @brief  : Set the states that call the event of a button, the other
+ *           states give no callback (the key sequences still see them).
+ *           e.g. Z_BTNMGR_EVENT_BIT(BtnSta_Clicked) |
+ *                Z_BTNMGR_EVENT_BIT(BtnSta_LongPressing)
+ * @param  : _btn   - point of button object.
+ *           _mask  - bits of states, Z_BTNMGR_EVENT_ALL by default
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setEventMask(z_btn_t* _btn,uint16_t _mask)
+{
+    z_err_t res = Z_ERR_OK;
+    if (__btnIsValid(__BTNCTX(_btn),_btn) == false) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    __HBTN(_btn,EventMask) = _mask;
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setDebounce
+ * @brief  : Set how the level of a button is debounced, the time is the
+ *           Debounce of its timing profile.
+ *           BtnDebounce_Deferred   : the level is reported when it was stable
+ *                                    for the time (default).
+ *           BtnDebounce_Eager      : the first edge is reported at once, then
+ *                                    the level is held for the time, the
+ *                                    bounces are not seen.
+ *           BtnDebounce_Integrator : the time pressed less the time released
+ *                                    is counted from 0 to the time, the level
+ *                                    changes when it reaches one end.
+ * @param  : _btn   - point of button object.
+ *           _mode  - debounce of button.
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setDebounce(z_btn_t* _btn,z_btn_debounce_t _mode)
+{
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+    uint8_t level = 0;
+    if (__btnIsValid(__BTNCTX(_btn),_btn) == false) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    switch (_mode) {
+    case BtnDebounce_Deferred:
+    case BtnDebounce_Eager:
+    case BtnDebounce_Integrator: {
+        // the filter starts at the level of the state, a held button is not released
+        level = __HBTN(_btn,State) == BtnSta_Pressing || __HBTN(_btn,State) == BtnSta_LongPressing;
+        __HBTN(_btn,DebounceMode) = (uint8_t)_mode;
+        __HBTN(_btn,Flags).Filter = level;
+        __HBTN(_btn,Flags).Hold = _mode == BtnDebounce_Integrator ? level : 0;
+        __HBTN(_btn,FilterTime) = (z_btntime_t)__BTNMGR(_btn)->TickCount;
+        __HBTN(_btn,FilterSum) = _mode == BtnDebounce_Integrator && level == 1 ? (z_btntime_t)0xFFFFFFFFUL : 0;
+#if Z_BTNMGR_MAX_BTNS > 0
+        __POOL_SETACTIVE(__BTNMGR(_btn),_btn->Id);
+#endif
+    }break;
+    default:res = Z_ERR_BADPARAM;break;
+    }
+#else
+    (void)_btn;
+    (void)_mode;
+    res = Z_ERR_FAILD;
+    goto error;
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_isPressing
+ * @brief  : Returns whether the button is pressed
+ * @param  : _btn  - point of button object.
+ * @return : res  - ture when button is pressing
+ *                - false that button is not pressing
+ */
+uint8_t z_btnmgr_isPressing(z_btn_t* _btn)
+{
+    uint8_t res = false;
+    if (__HBTN(_btn,State) == BtnSta_Pressing ||
+        __HBTN(_btn,State) == BtnSta_LongPressing) {
+        res = true;
+    }
+
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_wasPressed
+ * @brief  : Returns whether the button has been pressed
+ * @param  : _btn  - point of button object.
+ * @return : res  - ture when button was pressed
+ *                - false that button was not pressed
+ */
+uint8_t z_btnmgr_wasPressed(z_btn_t* _btn)
+{
+    uint8_t res = false;
+    if (__HBTN(_btn,Flags).Pressed == 1) {
+        __HBTN(_btn,Flags).Pressed = 0;
+        res = true;
+    }
+
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_isReleasing
+ * @brief  : Returns whether the button is released
+ * @param  : _btn  - point of button object.
+ * @return : res  - ture when button is prleasing
+ *                - false that button is not prleasing
+ */
+uint8_t z_btnmgr_isReleasing(z_btn_t* _btn)
+{
+    uint8_t res = false;
+    if (__HBTN(_btn,State) == BtnSta_Releasing) {
+        res = true;
+    }
+
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_getLatency
+ * @brief  : Returns the most time from the first pressed read of the
+ *           button to its BtnSta_Pressing event (Z_BTNMGR_STATS)
+ * @param  : _btn  - point of button object.
+ * @return : res  - time(ticks of the clock), 0 when the statistics are not enabled
+ */
+uint32_t z_btnmgr_getLatency(z_btn_t* _btn)
+{
+    uint32_t res = 0;
+#if Z_BTNMGR_STATS > 0
+    if (__btnIsValid(__BTNCTX(_btn),_btn) == false) {
+        goto error;
+    }
+    res = __HBTN(_btn,LatencyMax);
+error:
+#else
+    (void)_btn;
+#endif
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __portUpdateProc
+ * @brief  : Update a input port with a new sample,
+ *           and debounce all bits by vertical counter
+ * @param  : _ctx   - a button manager
+ *           _port  - a input port
+ *           _raw   - sample of the port
+ * @return : none
+ */
+static inline void __portUpdateProc(z_btnmgr_ctx_t* _ctx,z_btnport_t* _port,z_portval_t _raw)
+{
+    z_portval_t delta = 0;
+
+    _port->Raw = _raw;
+    if (_port->Flags.Debounce == 1) {
+        // 2 bits counter of every bit, reset while the bit is same as Value
+        delta = _raw ^ _port->Value;
+        _port->Cnt1 = (_port->Cnt1 ^ _port->Cnt0) & delta;
+        _port->Cnt0 = ~_port->Cnt0 & delta;
+        _port->Changed = delta & ~(_port->Cnt0 | _port->Cnt1);
+    }
+    else {
+        _port->Changed = _raw ^ _port->Value;
+    }
+    _port->Value ^= _port->Changed;
+#if Z_BTNMGR_MAX_BTNS > 0
+    if (_port->Changed != 0) {
+        __poolWakePort(_ctx,_port);
+    }
+#else
+    (void)_ctx;
+#endif
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __matrixScanProc
+ * @brief  : Scan a key matrix row by row.
+ *           When 2 rows have 2 same columns pressed, one key of the
+ *           rectangle may be a ghost key, these rows keep the last value.
+ * @param  : _ctx     - a button manager
+ *           _matrix  - a key matrix
+ * @return : none
+ */
+static inline void __matrixScanProc(z_btnmgr_ctx_t* _ctx,z_btnmatrix_t* _matrix)
+{
+    uint8_t i = 0, j = 0;
+    z_portval_t both = 0;
+    z_btnport_t* rows = _matrix->Rows;
+
+    for (i = 0; i < _matrix->RowNum; i++) {
+        _matrix->DriveRow(i);
+        rows[i].Raw = _matrix->ReadCols();
+    }
+    _matrix->GhostRows = 0;
+    for (i = 0; i < _matrix->RowNum; i++) {
+        for (j = i + 1; j < _matrix->RowNum; j++) {
+            both = rows[i].Raw & rows[j].Raw;
+            if ((both & (both - 1)) != 0) {
+                _matrix->GhostRows |= (1UL << i) | (1UL << j);
+            }
+        }
+    }
+    for (i = 0; i < _matrix->RowNum; i++) {
+        if ((_matrix->GhostRows & (1UL << i)) != 0) {
+            rows[i].Changed = 0;
+        }
+        else {
+            __portUpdateProc(_ctx,&rows[i],rows[i].Raw);
+        }
+    }
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __ladderScanProc
+ * @brief  : Read the ADC of a resistor ladder once, find the nearest
+ *           level by binary search, and update the port with the
+ *           buttons of the level. The level changes only when the
+ *           sample is past the middle of two levels by the hysteresis.
+ * @param  : _ctx     - a button manager
+ *           _ladder  - a resistor ladder
+ * @return : none
+ */
+static inline void __ladderScanProc(z_btnmgr_ctx_t* _ctx,z_btnladder_t* _ladder)
+{
+    const z_btnlevel_t* levels = _ladder->Levels;
+    uint16_t sample = _ladder->ReadAdc();
+    uint8_t low = 0;
+    uint8_t high = _ladder->LevelNum - 1;
+    uint8_t mid = 0;
+    uint8_t cur = _ladder->Level;
+    uint32_t edge = 0;
+
+    // the first level that is not below the sample
+    while (low < high) {
+        mid = (low + high) >> 1;
+        if (levels[mid].Value < sample) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    // or the level below it, when it is nearer
+    if (low > 0 && sample - levels[low - 1].Value < levels[low].Value - sample) {
+        low--;
+    }
+    if (low > cur) {
+        edge = ((uint32_t)levels[cur].Value + levels[cur + 1].Value) / 2 + _ladder->Hysteresis;
+        if (sample >= edge) {
+            _ladder->Level = low;
+        }
+    }
+    else if (low < cur) {
+        edge = ((uint32_t)levels[cur - 1].Value + levels[cur].Value + 1) / 2;
+        if ((uint32_t)sample + _ladder->Hysteresis <= edge) {
+            _ladder->Level = low;
+        }
+    }
+    __portUpdateProc(_ctx,&_ladder->Port,levels[_ladder->Level].Btns);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __shiftScanProc
+ * @brief  : Read a shift register chain in one transfer, and update
+ *           its ports a word at a time
+ * @param  : _ctx    - a button manager
+ *           _shift  - a shift register chain
+ * @return : none
+ */
+static inline void __shiftScanProc(z_btnmgr_ctx_t* _ctx,z_btnshift_t* _shift)
+{
+    const uint8_t* buf = _shift->Buf;
+    z_portval_t raw = 0;
+    uint16_t pos = 0;
+    uint16_t port = 0;
+    uint8_t shift = 0;
+
+    _shift->ReadBytes(_shift->Buf,_shift->Len);
+    while (pos < _shift->Len) {
+        raw = 0;
+        for (shift = 0; shift < Z_BTNMGR_PORT_WIDTH && pos < _shift->Len; shift += 8) {
+            raw |= (z_portval_t)buf[pos++] << shift;
+        }
+        if (_shift->Invert != 0) {
+            raw = ~raw;
+        }
+        // the bits past the chain are released
+        if (shift < Z_BTNMGR_PORT_WIDTH) {
+            raw &= ((z_portval_t)1 << shift) - 1;
+        }
+        __portUpdateProc(_ctx,&_shift->Ports[port++],raw);
+    }
+}
+
+#if Z_BTNMGR_EDGE_QUEUE_SIZE > 0
+/**-------------------------------------------------------------------
+ * @fn     : __edgeQueueProc
+ * @brief  : Handle the edges recorded since the last tick,by order.
+ *           The button runs to the time of edge with the old level,
+ *           then the new level is set at the same time.
+ * @param  : _ctx  - a button manager
+ *           _now  - time of this tick
+ * @return : none
+ */
+static inline void __edgeQueueProc(z_btnmgr_ctx_t* _ctx,uint32_t _now)
+{
+    uint16_t tail = _ctx->EdgeTail;
+    uint32_t now = _ctx->TickCount;
+    z_btnedge_t* edge_p = 0;
+    z_btnref_t btn = __BTNREF_NONE;
+
+    while (tail != _ctx->EdgeHead) {
+        Z_BTNMGR_BARRIER();
+        edge_p = &_ctx->EdgeQueue[tail];
+        // not earlier than the edge before, not later than this tick
+        if (__TIME_AFTER(edge_p->Time,_now)) {
+            now = _now;
+        }
+        else if (__TIME_AFTER(edge_p->Time,now)) {
+            now = edge_p->Time;
+        }
+        _ctx->TickCount = now;
+        btn = __BTNREF(edge_p->Btn);
+        z_btnmgr_btnProc(_ctx,btn);
+        if (__BTN(btn,State) == BtnSta_Clicked ||
+            __BTN(btn,State) == BtnSta_Pressed) {
+            z_btnmgr_btnProc(_ctx,btn);
+        }
+        __BTN(btn,Flags).Level = edge_p->Level;
+        z_btnmgr_btnProc(_ctx,btn);
+#if Z_BTNMGR_MAX_BTNS > 0
+        __POOL_SETACTIVE(_ctx,btn);
+#endif
+
+        tail = (tail + 1) & Z_BTNMGR_EDGE_QUEUE_MASK;
+        Z_BTNMGR_BARRIER();
+        _ctx->EdgeTail = tail;
+    }
+}
+#endif
+
+#if Z_BTNMGR_TRACE_SIZE > 0
+/**-------------------------------------------------------------------
+ * @fn     : __traceVarPut
+ * @brief  : Write a value as 7 bits per byte, the high bit is set
+ *           when more bytes follow
+ * @param  : _buf  - at least 5 bytes
+ *           _val  - value
+ * @return : res   - number of bytes
+ */
+static uint8_t __traceVarPut(uint8_t* _buf,uint32_t _val)
+{
+    uint8_t res = 0;
+    do {
+        _buf[res] = (uint8_t)(_val & 0x7F);
+        _val >>= 7;
+        if (_val != 0) {
+            _buf[res] |= 0x80;
+        }
+        res++;
+    } while (_val != 0);
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __traceVarGet
+ * @brief  : Read a value written by __traceVarPut
+ * @param  : _buf   - trace data
+ *           _wrap  - size of ring, or 0 when it is not a ring
+ *           _end   - end of data
+ *           _pos   - position, moved to the next value
+ * @return : res   - value
+ */
+static uint32_t __traceVarGet(const uint8_t* _buf,uint32_t _wrap,uint32_t _end,uint32_t* _pos)
+{
+    uint32_t res = 0;
+    uint8_t shift = 0;
+    uint8_t byte = 0x80;
+    while ((byte & 0x80) != 0 && *_pos != _end && shift < 32) {
+        byte = _buf[*_pos];
+        res |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+        *_pos = *_pos + 1;
+        if (_wrap != 0 && *_pos == _wrap) {
+            *_pos = 0;
+        }
+    }
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __traceDropProc
+ * @brief  : Drop the oldest record of the ring, its levels and time
+ *           go to the base of trace
+ * @param  : _ctx  - a button manager
+ * @return : none
+ */
+static void __traceDropProc(z_btnmgr_ctx_t* _ctx)
+{
+    uint32_t pos = _ctx->TraceTail;
+    uint32_t head = __traceVarGet(_ctx->TraceBuf,Z_BTNMGR_TRACE_SIZE,0xFFFFFFFFUL,&pos);
+    uint32_t ms = __traceVarGet(_ctx->TraceBuf,Z_BTNMGR_TRACE_SIZE,0xFFFFFFFFUL,&pos);
+    uint32_t i = 0, id = 0;
+    if ((head & 0x01) == 0) {
+        _ctx->TraceBaseTick += (head >> 1) * ms;
+    }
+    else {
+        _ctx->TraceBaseTick += ms;
+        for (i = 0; i < (head >> 1); i++) {
+            id += __traceVarGet(_ctx->TraceBuf,Z_BTNMGR_TRACE_SIZE,0xFFFFFFFFUL,&pos);
+            __TRACE_FLIP(_ctx->TraceBaseLevel,id);
+        }
+    }
+    _ctx->TraceUsed -= (pos + Z_BTNMGR_TRACE_SIZE - _ctx->TraceTail) % Z_BTNMGR_TRACE_SIZE;
+    _ctx->TraceTail = pos;
+    if (_ctx->TraceUsed == 0) {
+        _ctx->TraceTail = _ctx->TraceHead;
+    }
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __tracePut
+ * @brief  : Write a value at the head of ring, the room is checked before
+ * @param  : _ctx  - a button manager
+ *           _val  - value
+ * @return : none
+ */
+static void __tracePut(z_btnmgr_ctx_t* _ctx,uint32_t _val)
+{
+    uint8_t var[5];
+    uint8_t i = 0, n = __traceVarPut(var,_val);
+    for (i = 0; i < n; i++) {
+        _ctx->TraceBuf[_ctx->TraceHead] = var[i];
+        _ctx->TraceHead = (_ctx->TraceHead + 1) % Z_BTNMGR_TRACE_SIZE;
+    }
+    _ctx->TraceUsed += n;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __traceWriteProc
+ * @brief  : Write a record into the ring, the oldest records are dropped
+ *           to make room.
+ *           Ticks without change : (number of ticks << 1) , ms
+ *           A tick with changes  : (number of ids << 1) | 1 , ms , ids of
+ *                                  the changed levels, each one minus
+ *                                  the id before
+ * @param  : _ctx   - a button manager
+ *           _idle  - 1 : the ticks without change , 0 : this tick
+ *           _ms    - time of tick
+ * @return : none
+ */
+static void __traceWriteProc(z_btnmgr_ctx_t* _ctx,uint8_t _idle,uint32_t _ms)
+{
+    uint8_t var[5];
+    uint32_t head = _ctx->TraceIdleNum << 1;
+    uint32_t len = 0, id = 0, last = 0;
+
+    if (_idle == 0) {
+        head = 0x01;
+        for (id = 0; id < Z_BTNMGR_TRACE_BTNS; id++) {
+            if (_ctx->TraceChanged[id >> 5] == 0) {
+                id |= 0x1F;
+            }
+            else if (__TRACE_BIT(_ctx->TraceChanged,id) != 0) {
+                len += __traceVarPut(var,id - last);
+                last = id;
+                head += 2;
+            }
+        }
+    }
+    len += __traceVarPut(var,head) + __traceVarPut(var,_ms);
+    // a record larger than the ring, the trace starts again after it
+    if (len > Z_BTNMGR_TRACE_SIZE) {
+        _ctx->TraceHead = 0;
+        _ctx->TraceTail = 0;
+        _ctx->TraceUsed = 0;
+        _ctx->TraceBaseTick = _ctx->TickCount;
+        memcpy(_ctx->TraceBaseLevel,_ctx->TraceLevel,sizeof(_ctx->TraceBaseLevel));
+        goto error;
+    }
+    while (Z_BTNMGR_TRACE_SIZE - _ctx->TraceUsed < len) {
+        __traceDropProc(_ctx);
+    }
+    __tracePut(_ctx,head);
+    __tracePut(_ctx,_ms);
+    last = 0;
+    for (id = 0; id < Z_BTNMGR_TRACE_BTNS && _idle == 0; id++) {
+        if (_ctx->TraceChanged[id >> 5] == 0) {
+            id |= 0x1F;
+        }
+        else if (__TRACE_BIT(_ctx->TraceChanged,id) != 0) {
+            __tracePut(_ctx,id - last);
+            last = id;
+        }
+    }
+
+error:
+    return;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __traceTickProc
+ * @brief  : Record the levels that changed in this tick, the ticks
+ *           without change are counted and written as one record
+ * @param  : _ctx  - a button manager
+ *           _ms   - time of tick
+ * @return : none
+ */
+static void __traceTickProc(z_btnmgr_ctx_t* _ctx,uint32_t _ms)
+{
+    uint16_t i = 0;
+    uint8_t changed = false;
+    if (_ctx->TraceReplay == true) {
+        goto error;
+    }
+    for (i = 0; i < Z_BTNMGR_TRACE_WORDS; i++) {
+        if (_ctx->TraceChanged[i] != 0) {
+            changed = true;
+            break;
+        }
+    }
+    if (_ctx->TraceIdleNum != 0 && (changed == true || _ctx->TraceIdleMs != _ms)) {
+        __traceWriteProc(_ctx,1,_ctx->TraceIdleMs);
+        _ctx->TraceIdleNum = 0;
+    }
+    if (changed == true) {
+        __traceWriteProc(_ctx,0,_ms);
+        memset(_ctx->TraceChanged,0,sizeof(_ctx->TraceChanged));
+    }
+    else {
+        _ctx->TraceIdleMs = _ms;
+        _ctx->TraceIdleNum++;
+    }
+
+error:
+    return;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __traceLevelProc
+ * @brief  : Record the level read from a button, or give the level
+ *           of the trace while it is replayed
+ * @param  : _ctx    - a button manager
+ *           _id     - id of button
+ *           _level  - level that was read
+ * @return : res   - level of button
+ */
+static inline uint8_t __traceLevelProc(z_btnmgr_ctx_t* _ctx,uint16_t _id,uint8_t _level)
+{
+    uint8_t res = _level;
+    if (_id >= Z_BTNMGR_TRACE_BTNS) {
+        goto error;
+    }
+    if (_ctx->TraceReplay == true) {
+        res = (uint8_t)__TRACE_BIT(_ctx->TraceLevel,_id);
+    }
+    else if (__TRACE_BIT(_ctx->TraceLevel,_id) != _level) {
+        __TRACE_FLIP(_ctx->TraceLevel,_id);
+        __TRACE_FLIP(_ctx->TraceChanged,_id);
+    }
+
+error:
+    return res;
+}
+#endif
+
+#if Z_BTNMGR_STATS > 0
+/**-------------------------------------------------------------------
+ * @fn     : __bitHighest
+ * @brief  : Index of the highest bit that is set, the bin of histogram
+ * @param  : _val  - a value
+ * @return : res   - index of bit, 0 when _val is 0
+ */
+static inline uint8_t __bitHighest(uint32_t _val)
+{
+#if defined(__GNUC__)
+    return _val == 0 ? 0 : (uint8_t)(31 - __builtin_clz(_val));
+#else
+    uint8_t res = 0;
+    while (_val > 1) {
+        _val >>= 1;
+        res++;
+    }
+    return res;
+#endif
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __statsTickProc
+ * @brief  : Record the cycles and the events of a tick
+ * @param  : _ctx     - a button manager
+ *           _cycles  - cycles of the tick
+ * @return : none
+ */
+static inline void __statsTickProc(z_btnmgr_ctx_t* _ctx,uint32_t _cycles)
+{
+    z_btnstats_t* stats_p = &_ctx->Stats;
+    stats_p->Ticks++;
+    stats_p->TickHist[__bitHighest(_cycles)]++;
+    if (_cycles > stats_p->TickMax) {
+        stats_p->TickMax = _cycles;
+    }
+    stats_p->Events += _ctx->StatsEvents;
+    if (_ctx->StatsEvents > stats_p->EventsMax) {
+        stats_p->EventsMax = _ctx->StatsEvents;
+    }
+    _ctx->StatsEvents = 0;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __statsLatencyProc
+ * @brief  : Record the time from the first pressed read of a button
+ *           to its BtnSta_Pressing event
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ * @return : none
+ */
+static inline void __statsLatencyProc(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    uint32_t latency = __TIME_SINCE(__BTNTIME(_btn,StartPresseTime));
+    uint8_t bin = __bitHighest(latency);
+    _ctx->Stats.LatencyHist[bin < 15 ? bin : 15]++;
+    if (latency > _ctx->Stats.LatencyMax) {
+        _ctx->Stats.LatencyMax = latency;
+    }
+    if (latency > __BTN(_btn,LatencyMax)) {
+        __BTN(_btn,LatencyMax) = latency > 0xFFFF ? 0xFFFF : (uint16_t)latency;
+    }
+}
+#endif
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxTick
+ * @brief  : Cycle and operation
+ * @param  : _ctx  - a button manager
+ *           _ms  Time since the last tick, in ticks of the clock (Z_BTNMGR_CLOCK_PER_MS).
+ *                The recommended time interval for each call is 1-10ms
+ * @return : res  - error status
+ */
+inline void z_btnmgr_ctxTick(z_btnmgr_ctx_t* _ctx,uint32_t _ms)
+{
+    z_blist_t *blist_pbuf = &_ctx->Btns_BListHead;
+#if Z_BTNMGR_MAX_BTNS == 0
+    z_btn_t* btn_p = 0;
+#endif
+    z_btngroup_t* group_p = 0;
+    z_btnport_t* port_p = 0;
+    z_btnmatrix_t* matrix_p = 0;
+    z_btnladder_t* ladder_p = 0;
+    z_btnshift_t* shift_p = 0;
+    uint32_t now = _ctx->TickCount + _ms;
+#if Z_BTNMGR_STATS > 0
+    uint32_t cycles = Z_BTNMGR_CYCLES();
+#endif
+
+#if Z_BTNMGR_EDGE_QUEUE_SIZE > 0
+    __edgeQueueProc(_ctx,now);
+#endif
+    _ctx->TickCount = now;
+    // Input Port
+    blist_pbuf = &_ctx->Ports_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->Ports_BListHead)
+    {
+        port_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                  z_btnport_t*,
+                                  List);
+        __portUpdateProc(_ctx,port_p,port_p->ReadPort());
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    // Key Matrix
+    blist_pbuf = &_ctx->Matrix_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->Matrix_BListHead)
+    {
+        matrix_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                    z_btnmatrix_t*,
+                                    List);
+        __matrixScanProc(_ctx,matrix_p);
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    // Resistor Ladder
+    blist_pbuf = &_ctx->Ladder_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->Ladder_BListHead)
+    {
+        ladder_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                    z_btnladder_t*,
+                                    List);
+        __ladderScanProc(_ctx,ladder_p);
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    // Shift Register
+    blist_pbuf = &_ctx->Shift_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->Shift_BListHead)
+    {
+        shift_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                   z_btnshift_t*,
+                                   List);
+        __shiftScanProc(_ctx,shift_p);
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    // One Button
+#if Z_BTNMGR_MAX_BTNS > 0
+    // the buttons of groups are handled here too, the buttons of the
+    // port bits that changed were put in the active set by the ports
+#if Z_BTNMGR_WHEEL_BITS > 0
+    __wheelProc(_ctx);
+#endif
+    __poolActiveProc(_ctx);
+#else
+    blist_pbuf = &_ctx->Btns_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->Btns_BListHead)
+    {
+        btn_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                  z_btn_t*,
+                                  List);
+        z_btnmgr_btnProc(_ctx,btn_p);
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+#endif
+    // Button Group
+    blist_pbuf = &_ctx->BtnGrounp_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->BtnGrounp_BListHead)
+    {
+        group_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                   z_btngroup_t*,
+                                   List);
+        // todo
+        z_btnmgr_groupProc(_ctx,group_p);
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    // Chord
+#if Z_BTNMGR_CHORD_BTNS > 0
+    if (_ctx->ChordChanged == true) {
+        _ctx->ChordChanged = false;
+        __chordProc(_ctx);
+    }
+#endif
+#if Z_BTNMGR_BATCH_SIZE > 0 && Z_BTNMGR_EVENT_QUEUE_SIZE == 0
+    if (_ctx->BatchEvent != 0) {
+        __batchFlush(_ctx,true);
+    }
+#endif
+#if Z_BTNMGR_TRACE_SIZE > 0
+    __traceTickProc(_ctx,_ms);
+#endif
+#if Z_BTNMGR_STATS > 0
+    __statsTickProc(_ctx,Z_BTNMGR_CYCLES() - cycles);
+#endif
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxTickTo
+ * @brief  : Cycle and operation, to the time of a free running clock.
+ *           The first call moves the tick count to the clock, the
+ *           clock may wrap, the calls must be less than 2^31 ticks apart.
+ * @param  : _ctx  - a button manager
+ *           _now  - time of the clock, in ticks of Z_BTNMGR_CLOCK_PER_MS per ms
+ * @return : none
+ */
+void z_btnmgr_ctxTickTo(z_btnmgr_ctx_t* _ctx,uint32_t _now)
+{
+    z_btnmgr_ctxTick(_ctx,_now - _ctx->TickCount);
+}
+
+#if Z_BTNMGR_BATCH_SIZE > 0 && Z_BTNMGR_EVENT_QUEUE_SIZE == 0
+/**-------------------------------------------------------------------
+ * @fn     : __batchFlush
+ * @brief  : Give the events waiting in the batch to the batch callback
+ * @param  : _ctx  - a button manager
+ *           _end  - true at the end of the tick, false when the batch is full
+ * @return : none
+ */
+static void __batchFlush(z_btnmgr_ctx_t* _ctx,uint8_t _end)
+{
+    uint16_t num = _ctx->BatchNum;
+    if (num != 0) {
+        _ctx->BatchNum = 0;
+        _ctx->BatchEvent(_ctx->Batch,num,_end);
+    }
+}
+#endif
+
+/**-------------------------------------------------------------------
+ * @fn     : __eventEmit
+ * @brief  : Call the event callback, or put the event in the queue
+ *           for z_btnmgr_dispatch
+ * @param  : _ctx    - a button manager
+ *           _obj    - a Button object or a Button group
+ *           _event  - callback function of the object
+ *           _sta    - status of object
+ *           _edge   - tick count of the edge of the event
+ *           _id     - id of the button in the pool, Z_BTNMGR_ID_NONE for the others
+ * @return : none
+ */
+static inline void __eventEmit(z_btnmgr_ctx_t* _ctx,const void* _obj,z_click_event _event,z_btn_state_t _sta,
+                               uint32_t _edge,uint16_t _id)
+{
+#if Z_BTNMGR_STATS > 0
+    _ctx->StatsEvents++;
+#endif
+#if Z_BTNMGR_EDGE_TIME == 0
+    (void)_edge;
+#endif
+#if Z_BTNMGR_MAX_BTNS == 0
+    (void)_id;
+#endif
+#if Z_BTNMGR_EVENT_QUEUE_SIZE > 0
+    uint16_t head = _ctx->EventHead;
+    uint16_t next = (head + 1) & Z_BTNMGR_EVENT_QUEUE_MASK;
+    uint16_t used = 0;
+    if (next == _ctx->EventTail) {
+        _ctx->EventLost++;
+        goto error;
+    }
+    _ctx->EventQueue[head].Obj = _obj;
+    _ctx->EventQueue[head].Event = _event;
+    _ctx->EventQueue[head].Time = _ctx->TickCount;
+#if Z_BTNMGR_EDGE_TIME > 0
+    _ctx->EventQueue[head].EdgeTime = _edge;
+#endif
+#if Z_BTNMGR_MAX_BTNS > 0
+    _ctx->EventQueue[head].Id = _id;
+#endif
+    _ctx->EventQueue[head].State = (uint8_t)_sta;
+    Z_BTNMGR_BARRIER();
+    _ctx->EventHead = next;
+    used = (next - _ctx->EventTail) & Z_BTNMGR_EVENT_QUEUE_MASK;
+    if (used > _ctx->EventPeak) {
+        _ctx->EventPeak = used;
+    }
+#else
+    z_btn_args_t args;
+#if Z_BTNMGR_BATCH_SIZE > 0
+    z_btnevent_t* event_p = 0;
+    if (_ctx->BatchEvent != 0) {
+        // the full batch is given before the event, the last call of the tick has more events
+        if (_ctx->BatchNum >= Z_BTNMGR_BATCH_SIZE) {
+            __batchFlush(_ctx,false);
+        }
+        event_p = &_ctx->Batch[_ctx->BatchNum++];
+        event_p->Obj = _obj;
+        event_p->Event = _event;
+        event_p->Time = _ctx->TickCount;
+#if Z_BTNMGR_EDGE_TIME > 0
+        event_p->EdgeTime = _edge;
+#endif
+#if Z_BTNMGR_MAX_BTNS > 0
+        event_p->Id = _id;
+#endif
+        event_p->State = (uint8_t)_sta;
+        goto error;
+    }
+#endif
+    args.Obj = _obj;
+    args.State = _sta;
+    args.Time = _ctx->TickCount;
+#if Z_BTNMGR_EDGE_TIME > 0
+    args.EdgeTime = _edge;
+#endif
+#if Z_BTNMGR_MAX_BTNS > 0
+    args.Id = _id;
+#endif
+    _event(args);
+    goto error;
+#endif
+
+error:
+    return;
+}
+
+#if Z_BTNMGR_SEQ_NODES > 0
+/**-------------------------------------------------------------------
+ * @fn     : __seqSymbol
+ * @brief  : Symbol of a event in the automaton of key sequences
+ * @param  : _ctx  - a button manager
+ *           _obj  - a Button object , a Button group or a chord
+ *           _sta  - status of object
+ *           _add  - add the symbol when it is not found
+ * @return : res   - symbol , __SEQ_SYM_NONE when it is not a step
+ */
+static uint8_t __seqSymbol(z_btnmgr_ctx_t* _ctx,const void* _obj,uint8_t _sta,uint8_t _add)
+{
+    uint8_t res = __SEQ_SYM_NONE;
+    uint8_t slot = __SEQ_HASH(_obj,_sta);
+    uint8_t sym = 0;
+    // the hash is at most half full
+    while ((sym = _ctx->SeqSymHash[slot]) != 0) {
+        if (_ctx->SeqSymObj[sym - 1] == _obj && _ctx->SeqSymState[sym - 1] == _sta) {
+            res = sym - 1;
+            goto error;
+        }
+        slot = (slot + 1) & (Z_BTNMGR_SEQ_SYMS * 2 - 1);
+    }
+    if (_add == true && _ctx->SeqSymNum < Z_BTNMGR_SEQ_SYMS) {
+        res = _ctx->SeqSymNum++;
+        _ctx->SeqSymObj[res] = _obj;
+        _ctx->SeqSymState[res] = _sta;
+        _ctx->SeqSymHash[slot] = res + 1;
+    }
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __seqBuild
+ * @brief  : Compile all key sequences of a manager into one automaton :
+ *           a trie of the steps, then every missing transition goes
+ *           where the longest suffix of the steps goes (Aho-Corasick).
+ *           A step shared by sequences has the widest window.
+ * @param  : _ctx  - a button manager
+ * @return : res   - error status
+ */
+static z_err_t __seqBuild(z_btnmgr_ctx_t* _ctx)
+{
+    z_err_t res = Z_ERR_OK;
+    z_blist_t *blist_pbuf = &_ctx->Seq_BListHead;
+    z_btnseq_t* seq_p = 0;
+    const z_btnstep_t* step_p = 0;
+    uint8_t fail[Z_BTNMGR_SEQ_NODES];
+    uint8_t queue[Z_BTNMGR_SEQ_NODES];
+    uint8_t head = 0;
+    uint8_t tail = 0;
+    uint8_t node = 0;
+    uint8_t next = 0;
+    uint8_t sym = 0;
+    uint8_t i = 0;
+
+    memset(_ctx->SeqSymHash,0,sizeof(_ctx->SeqSymHash));
+    memset(_ctx->SeqNext,0,sizeof(_ctx->SeqNext));
+    memset(_ctx->SeqWindow,0,sizeof(_ctx->SeqWindow));
+    memset(_ctx->SeqOut,0,sizeof(_ctx->SeqOut));
+    _ctx->SeqSymNum = 0;
+    _ctx->SeqNodeNum = 1;
+    _ctx->SeqNode = 0;
+    // trie of the steps, node 0 is the root
+    while (blist_pbuf->NextNode != &_ctx->Seq_BListHead)
+    {
+        seq_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                 z_btnseq_t*,
+                                 List);
+        node = 0;
+        for (i = 0; i < seq_p->Num; i++) {
+            step_p = &seq_p->Steps[i];
+            sym = __seqSymbol(_ctx,step_p->Obj,(uint8_t)step_p->State,true);
+            if (sym == __SEQ_SYM_NONE) {
+                res = Z_ERR_OVERRANGE;
+                goto error;
+            }
+            next = _ctx->SeqNext[node][sym];
+            if (next == 0) {
+                if (_ctx->SeqNodeNum >= Z_BTNMGR_SEQ_NODES) {
+                    res = Z_ERR_OVERRANGE;
+                    goto error;
+                }
+                next = _ctx->SeqNodeNum++;
+                _ctx->SeqNext[node][sym] = next;
+                _ctx->SeqWindow[next] = i == 0 ? 0 : step_p->Window;
+            }
+            else if (_ctx->SeqWindow[next] != 0 &&
+                     (step_p->Window == 0 || step_p->Window > _ctx->SeqWindow[next])) {
+                _ctx->SeqWindow[next] = step_p->Window;
+            }
+            node = next;
+        }
+        // the same steps as another sequence
+        if (_ctx->SeqOut[node] != 0) {
+            res = Z_ERR_BADPARAM;
+            goto error;
+        }
+        _ctx->SeqOut[node] = seq_p;
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    // transitions of the automaton, by breadth first
+    for (sym = 0; sym < _ctx->SeqSymNum; sym++) {
+        next = _ctx->SeqNext[0][sym];
+        if (next != 0) {
+            fail[next] = 0;
+            queue[tail++] = next;
+        }
+    }
+    while (head != tail) {
+        node = queue[head++];
+        // a sequence that ends with the steps of this node
+        if (_ctx->SeqOut[node] == 0) {
+            _ctx->SeqOut[node] = _ctx->SeqOut[fail[node]];
+        }
+        for (sym = 0; sym < _ctx->SeqSymNum; sym++) {
+            next = _ctx->SeqNext[node][sym];
+            if (next != 0) {
+                fail[next] = _ctx->SeqNext[fail[node]][sym];
+                queue[tail++] = next;
+            }
+            else {
+                _ctx->SeqNext[node][sym] = _ctx->SeqNext[fail[node]][sym];
+            }
+        }
+    }
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __seqFeed
+ * @brief  : Give a event to the automaton of key sequences, one lookup
+ *           of the symbol and one transition, and call the event of the
+ *           sequence that is recognized.After it the automaton starts
+ *           again, a event is a step of one recognized sequence only.
+ * @param  : _ctx  - a button manager
+ *           _obj  - a Button object , a Button group or a chord
+ *           _sta  - status of object
+ * @return : none
+ */
+static void __seqFeed(z_btnmgr_ctx_t* _ctx,const void* _obj,z_btn_state_t _sta)
+{
+    uint8_t sym = __seqSymbol(_ctx,_obj,(uint8_t)_sta,false);
+    uint8_t next = 0;
+    z_btnseq_t* seq_p = 0;
+    if (sym == __SEQ_SYM_NONE) {
+        goto error;
+    }
+    next = _ctx->SeqNext[_ctx->SeqNode][sym];
+    // too late for the next step, start again from this event
+    if (_ctx->SeqWindow[next] != 0 && __TIME_SINCE(_ctx->SeqTime) > __MS(_ctx->SeqWindow[next])) {
+        next = _ctx->SeqNext[0][sym];
+    }
+    _ctx->SeqNode = next;
+    _ctx->SeqTime = _ctx->TickCount;
+    seq_p = _ctx->SeqOut[next];
+    if (seq_p != 0) {
+        _ctx->SeqNode = 0;
+        __eventEmit(_ctx,seq_p,seq_p->Event,BtnSta_Clicked,_ctx->TickCount,Z_BTNMGR_ID_NONE);
+    }
+
+error:
+    return;
+}
+#endif
+
+#if Z_BTNMGR_CHORD_BTNS > 0
+/**-------------------------------------------------------------------
+ * @fn     : __bitCount
+ * @brief  : Number of bits that are set
+ * @param  : _val  - a value
+ * @return : res   - number of bits
+ */
+static inline uint8_t __bitCount(uint32_t _val)
+{
+#if defined(__GNUC__)
+    return (uint8_t)__builtin_popcount(_val);
+#else
+    _val = _val - ((_val >> 1) & 0x55555555UL);
+    _val = (_val & 0x33333333UL) + ((_val >> 2) & 0x33333333UL);
+    return (uint8_t)((((_val + (_val >> 4)) & 0x0F0F0F0FUL) * 0x01010101UL) >> 24);
+#endif
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __chordKeyProc
+ * @brief  : Update the key set of chords with the state of a button
+ * @param  : _ctx       - a button manager
+ *           _id        - id of button
+ *           _pressing  - button is pressing
+ * @return : none
+ */
+static inline void __chordKeyProc(z_btnmgr_ctx_t* _ctx,uint16_t _id,uint8_t _pressing)
+{
+    if (_id < Z_BTNMGR_CHORD_BTNS && __CHORD_BIT(_ctx->ChordPressed,_id) != _pressing) {
+        __CHORD_FLIP(_ctx->ChordPressed,_id);
+        _ctx->ChordChanged = true;
+    }
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __chordMatch
+ * @brief  : Match the keys pressing with a chord, a few word operations
+ * @param  : _ctx    - a button manager
+ *           _chord  - a chord
+ *           _any    - returns whether a key of the chord is pressing
+ * @return : res   - true when the chord is matched
+ */
+static inline uint8_t __chordMatch(z_btnmgr_ctx_t* _ctx,z_btnchord_t* _chord,uint8_t* _any)
+{
+    uint32_t hit = 0;
+    uint32_t miss = 0;
+    uint32_t other = 0;
+    uint16_t num = 0;
+    uint8_t i = 0;
+    uint8_t res = false;
+    for (i = 0; i < Z_BTNMGR_CHORD_WORDS; i++) {
+        hit = _ctx->ChordPressed[i] & _chord->Keys[i];
+        miss |= hit ^ _chord->Keys[i];
+        other |= _ctx->ChordPressed[i] & ~_chord->Keys[i];
+        num += __bitCount(hit);
+    }
+    *_any = num != 0;
+    switch (_chord->Mode) {
+    case ChordMode_All: res = num != 0 && miss == 0; break;
+    case ChordMode_Exact: res = num != 0 && miss == 0 && other == 0; break;
+    case ChordMode_Any: res = num >= _chord->Need; break;
+    default: break;
+    }
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __chordEmit
+ * @brief  : Change the state of a chord and call its event
+ * @param  : _ctx    - a button manager
+ *           _chord  - a chord
+ *           _sta    - status of chord
+ * @return : none
+ */
+static inline void __chordEmit(z_btnmgr_ctx_t* _ctx,z_btnchord_t* _chord,z_btn_state_t _sta)
+{
+    _chord->State = _sta;
+    __eventEmit(_ctx,_chord,_chord->Event,_sta,_ctx->TickCount,Z_BTNMGR_ID_NONE);
+#if Z_BTNMGR_SEQ_NODES > 0
+    __seqFeed(_ctx,_chord,_sta);
+#endif
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __chordProc
+ * @brief  : Match all chords with the keys pressing, only when a key
+ *           changed, and update the keys without event
+ * @param  : _ctx  - a button manager
+ * @return : none
+ */
+static void __chordProc(z_btnmgr_ctx_t* _ctx)
+{
+    z_blist_t *blist_pbuf = &_ctx->Chord_BListHead;
+    z_btnchord_t* chord_p = 0;
+    uint8_t match = 0;
+    uint8_t any = 0;
+    uint8_t i = 0;
+
+    memset(_ctx->ChordMutex,0,sizeof(_ctx->ChordMutex));
+    while (blist_pbuf->NextNode != &_ctx->Chord_BListHead)
+    {
+        chord_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                   z_btnchord_t*,
+                                   List);
+        match = __chordMatch(_ctx,chord_p,&any);
+        if (match == true && chord_p->State != BtnSta_Pressing) {
+            __chordEmit(_ctx,chord_p,BtnSta_Pressing);
+        }
+        else if (match == false && chord_p->State == BtnSta_Pressing) {
+            __chordEmit(_ctx,chord_p,BtnSta_Clicked);
+        }
+        if (any == false && chord_p->State == BtnSta_Clicked) {
+            __chordEmit(_ctx,chord_p,BtnSta_Releasing);
+        }
+        if (chord_p->Property == BrnGrpProp_Mutex && chord_p->State != BtnSta_Releasing) {
+            for (i = 0; i < Z_BTNMGR_CHORD_WORDS; i++) {
+                _ctx->ChordMutex[i] |= chord_p->Keys[i];
+            }
+        }
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+}
+#endif
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxDispatch
+ * @brief  : Call the event callbacks of the events in the queue,
+ *           by order.It is called in the main loop while z_btnmgr_tick
+ *           runs in a interrupt,only one task may call it.
+ * @param  : _ctx  - a button manager
+ *           _max  - the most events to be handled, 0 is all
+ * @return : res   - number of events that have been handled
+ */
+uint16_t z_btnmgr_ctxDispatch(z_btnmgr_ctx_t* _ctx,uint16_t _max)
+{
+    uint16_t res = 0;
+#if Z_BTNMGR_EVENT_QUEUE_SIZE > 0
+    uint16_t tail = _ctx->EventTail;
+    z_btnevent_t* event_p = 0;
+    z_click_event event = 0;
+    z_btn_args_t args;
+#if Z_BTNMGR_BATCH_SIZE > 0
+    uint16_t head = 0;
+    uint16_t num = 0;
+
+    // the events in the ring are given in place, up to the end of the ring
+    while (_ctx->BatchEvent != 0 && tail != _ctx->EventHead && (_max == 0 || res < _max)) {
+        head = _ctx->EventHead;
+        Z_BTNMGR_BARRIER();
+        num = head > tail ? head - tail : Z_BTNMGR_EVENT_QUEUE_SIZE - tail;
+        if (num > Z_BTNMGR_BATCH_SIZE) {
+            num = Z_BTNMGR_BATCH_SIZE;
+        }
+        if (_max != 0 && num > _max - res) {
+            num = _max - res;
+        }
+        // the slots are freed after the callback, the end is the head read above
+        _ctx->BatchEvent(&_ctx->EventQueue[tail],num,
+                         ((tail + num) & Z_BTNMGR_EVENT_QUEUE_MASK) == head ? true : false);
+        tail = (tail + num) & Z_BTNMGR_EVENT_QUEUE_MASK;
+        Z_BTNMGR_BARRIER();
+        _ctx->EventTail = tail;
+        res += num;
+    }
+#endif
+
+    while (tail != _ctx->EventHead && (_max == 0 || res < _max)) {
+        Z_BTNMGR_BARRIER();
+        event_p = &_ctx->EventQueue[tail];
+        event = event_p->Event;
+        args.Obj = event_p->Obj;
+        args.State = (z_btn_state_t)event_p->State;
+        args.Time = event_p->Time;
+#if Z_BTNMGR_EDGE_TIME > 0
+        args.EdgeTime = event_p->EdgeTime;
+#endif
+#if Z_BTNMGR_MAX_BTNS > 0
+        args.Id = event_p->Id;
+#endif
+        // free the slot before the callback, the tick may run in it
+        tail = (tail + 1) & Z_BTNMGR_EVENT_QUEUE_MASK;
+        Z_BTNMGR_BARRIER();
+        _ctx->EventTail = tail;
+        if (event != 0) {
+            event(args);
+        }
+        res++;
+    }
+#else
+    (void)_ctx;
+    (void)_max;
+#endif
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxSetBatchEvent
+ * @brief  : Set a callback that gets all events of a tick at once, in
+ *           place of the event callbacks. It is called at the end of
+ *           z_btnmgr_tick (or each Z_BTNMGR_BATCH_SIZE events, then
+ *           _end is false until the last call of the tick), or by
+ *           z_btnmgr_dispatch with the event queue (_end is true when
+ *           the call empties the queue).
+ * @param  : _ctx    - a button manager
+ *           _batch  - batch callback, 0 goes back to the event callbacks
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_ctxSetBatchEvent(z_btnmgr_ctx_t* _ctx,z_batch_event _batch)
+{
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_BATCH_SIZE > 0
+    if (_ctx == 0) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+#if Z_BTNMGR_EVENT_QUEUE_SIZE == 0
+    if (_ctx->BatchEvent != 0) {
+        __batchFlush(_ctx,true);
+    }
+#endif
+    _ctx->BatchEvent = _batch;
+#else
+    (void)_ctx;
+    (void)_batch;
+    res = Z_ERR_FAILD;
+    goto error;
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxGetQueueStat
+ * @brief  : Returns the statistics of the edge and event queues
+ * @param  : _ctx   - a button manager
+ *           _stat  - point of statistics
+ * @return : none
+ */
+void z_btnmgr_ctxGetQueueStat(z_btnmgr_ctx_t* _ctx,z_btnqueue_stat_t* _stat)
+{
+    if (_stat == 0) {
+        goto error;
+    }
+    memset(_stat,0,sizeof(z_btnqueue_stat_t));
+#if Z_BTNMGR_EDGE_QUEUE_SIZE > 0
+    _stat->EdgeLost = _ctx->EdgeLost;
+#endif
+#if Z_BTNMGR_EVENT_QUEUE_SIZE > 0
+    _stat->EventLost = _ctx->EventLost;
+    _stat->EventPeak = _ctx->EventPeak;
+#endif
+#if Z_BTNMGR_EDGE_QUEUE_SIZE == 0 && Z_BTNMGR_EVENT_QUEUE_SIZE == 0
+    (void)_ctx;
+#endif
+
+error:
+    return;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxGetStats
+ * @brief  : Returns the statistics of the hot path (Z_BTNMGR_STATS),
+ *           all 0 when they are not enabled
+ * @param  : _ctx    - a button manager
+ *           _stats  - point of statistics
+ * @return : none
+ */
+void z_btnmgr_ctxGetStats(z_btnmgr_ctx_t* _ctx,z_btnstats_t* _stats)
+{
+    if (_stats == 0) {
+        goto error;
+    }
+#if Z_BTNMGR_STATS > 0
+    memcpy(_stats,&_ctx->Stats,sizeof(z_btnstats_t));
+#else
+    (void)_ctx;
+    memset(_stats,0,sizeof(z_btnstats_t));
+#endif
+
+error:
+    return;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxClearStats
+ * @brief  : Clear the statistics of the hot path and the latency of
+ *           the buttons
+ * @param  : _ctx  - a button manager
+ * @return : none
+ */
+void z_btnmgr_ctxClearStats(z_btnmgr_ctx_t* _ctx)
+{
+#if Z_BTNMGR_STATS > 0
+#if Z_BTNMGR_MAX_BTNS > 0
+    memset(_ctx->Pool.LatencyMax,0,sizeof(_ctx->Pool.LatencyMax));
+#else
+    z_blist_t *blist_pbuf = &_ctx->Btns_BListHead;
+    z_blist_t *btnlist_pbuf = 0;
+    z_btngroup_t* group_p = 0;
+    z_btn_t* btn_p = 0;
+    while (blist_pbuf->NextNode != &_ctx->Btns_BListHead)
+    {
+        btn_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                 z_btn_t*,
+                                 List);
+        btn_p->LatencyMax = 0;
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    // the buttons of groups
+    blist_pbuf = &_ctx->BtnGrounp_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->BtnGrounp_BListHead)
+    {
+        group_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                   z_btngroup_t*,
+                                   List);
+        btnlist_pbuf = &group_p->BtnsList;
+        while (btnlist_pbuf->NextNode != &group_p->BtnsList)
+        {
+            btn_p = LIST_FIRST_ENTRY(btnlist_pbuf,
+                                     z_btn_t*,
+                                     List);
+            btn_p->LatencyMax = 0;
+            btnlist_pbuf = btnlist_pbuf->NextNode;
+        }
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+#endif
+    memset(&_ctx->Stats,0,sizeof(z_btnstats_t));
+#else
+    (void)_ctx;
+#endif
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxGetTrace
+ * @brief  : Copy the input trace of a manager, from the oldest record.
+ *           "ZT" , version , number of buttons , tick count before
+ *           the records , levels before the records (1 bit per button) ,
+ *           records (see __traceWriteProc)
+ * @param  : _ctx   - a button manager
+ *           _buf   - buffer of trace
+ *           _size  - size of buffer
+ * @return : res   - bytes of trace, 0 when the buffer is too small
+ *                   or the trace is disabled
+ */
+uint32_t z_btnmgr_ctxGetTrace(z_btnmgr_ctx_t* _ctx,uint8_t* _buf,uint32_t _size)
+{
+    uint32_t res = 0;
+#if Z_BTNMGR_TRACE_SIZE > 0
+    uint8_t head[32];
+    uint32_t idle = 0, i = 0, pos = 0;
+    if (_ctx == 0 || _buf == 0) {
+        goto error;
+    }
+    head[0] = Z_BTNMGR_TRACE_MAGIC0;
+    head[1] = Z_BTNMGR_TRACE_MAGIC1;
+    head[2] = Z_BTNMGR_TRACE_VERSION;
+    res = 3;
+    res += __traceVarPut(&head[res],Z_BTNMGR_TRACE_BTNS);
+    res += __traceVarPut(&head[res],_ctx->TraceBaseTick);
+    // the ticks without change that are not written yet
+    if (_ctx->TraceIdleNum != 0) {
+        idle = __traceVarPut(&head[res],_ctx->TraceIdleNum << 1);
+        idle += __traceVarPut(&head[res],_ctx->TraceIdleMs);
+    }
+    if (res + (Z_BTNMGR_TRACE_BTNS + 7) / 8 + _ctx->TraceUsed + idle > _size) {
+        res = 0;
+        goto error;
+    }
+    memcpy(_buf,head,res);
+    for (pos = 0; pos < (Z_BTNMGR_TRACE_BTNS + 7) / 8; pos++) {
+        _buf[res++] = (uint8_t)(_ctx->TraceBaseLevel[pos >> 2] >> ((pos & 0x03) * 8));
+    }
+    pos = _ctx->TraceTail;
+    for (i = 0; i < _ctx->TraceUsed; i++) {
+        _buf[res++] = _ctx->TraceBuf[pos];
+        pos = (pos + 1) % Z_BTNMGR_TRACE_SIZE;
+    }
+    if (_ctx->TraceIdleNum != 0) {
+        res += __traceVarPut(&_buf[res],_ctx->TraceIdleNum << 1);
+        res += __traceVarPut(&_buf[res],_ctx->TraceIdleMs);
+    }
+#else
+    (void)_ctx;
+    (void)_buf;
+    (void)_size;
+    goto error;
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxReplay
+ * @brief  : Run a trace of z_btnmgr_getTrace through the buttons of a
+ *           manager, as fast as it can, the events are called as in the
+ *           ticks that were recorded.
+ *           The buttons must be created in the same order and with the
+ *           same settings as the manager that recorded it, their read
+ *           functions are called but the levels come from the trace.
+ *           The edges of edge buttons are at the time of tick.
+ * @param  : _ctx    - a button manager
+ *           _trace  - trace data
+ *           _len    - bytes of trace
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_ctxReplay(z_btnmgr_ctx_t* _ctx,const uint8_t* _trace,uint32_t _len)
+{
+    z_err_t res = Z_ERR_OK;
+#if Z_BTNMGR_TRACE_SIZE > 0
+    uint32_t pos = 3;
+    uint32_t btns = 0, head = 0, ms = 0, i = 0, id = 0;
+    if (_ctx == 0 || _trace == 0 || _len < 3 ||
+        _trace[0] != Z_BTNMGR_TRACE_MAGIC0 || _trace[1] != Z_BTNMGR_TRACE_MAGIC1 ||
+        _trace[2] != Z_BTNMGR_TRACE_VERSION) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    btns = __traceVarGet(_trace,0,_len,&pos);
+    _ctx->TickCount = __traceVarGet(_trace,0,_len,&pos);
+    if (pos + (btns + 7) / 8 > _len) {
+        res = Z_ERR_BADPARAM;
+        goto error;
+    }
+    _ctx->TraceReplay = true;
+    memset(_ctx->TraceLevel,0,sizeof(_ctx->TraceLevel));
+    for (id = 0; id < btns; id++) {
+        if (id < Z_BTNMGR_TRACE_BTNS && ((_trace[pos + (id >> 3)] >> (id & 0x07)) & 0x01) != 0) {
+            __TRACE_FLIP(_ctx->TraceLevel,id);
+#if Z_BTNMGR_MAX_BTNS > 0
+            if (id < _ctx->Pool.Count) {
+                __POOL_SETACTIVE(_ctx,id);
+            }
+#endif
+        }
+    }
+    pos += (btns + 7) / 8;
+    while (pos < _len) {
+        head = __traceVarGet(_trace,0,_len,&pos);
+        ms = __traceVarGet(_trace,0,_len,&pos);
+        if ((head & 0x01) != 0) {
+            id = 0;
+            for (i = 0; i < (head >> 1); i++) {
+                id += __traceVarGet(_trace,0,_len,&pos);
+                if (id < Z_BTNMGR_TRACE_BTNS) {
+                    __TRACE_FLIP(_ctx->TraceLevel,id);
+#if Z_BTNMGR_MAX_BTNS > 0
+                    if (id < _ctx->Pool.Count) {
+                        __POOL_SETACTIVE(_ctx,id);
+                    }
+#endif
+                }
+            }
+            head = 0x02;
+        }
+        for (i = 0; i < (head >> 1); i++) {
+            z_btnmgr_ctxTick(_ctx,ms);
+#if Z_BTNMGR_EVENT_QUEUE_SIZE > 0
+            z_btnmgr_ctxDispatch(_ctx,0);
+#endif
+        }
+    }
+    _ctx->TraceReplay = false;
+#else
+    (void)_ctx;
+    (void)_trace;
+    (void)_len;
+    res = Z_ERR_FAILD;
+    goto error;
+#endif
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnCallEventProc
+ * @brief  : Event handling of button status
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ *           _sta  - status of button
+ * @return : none
+ */
+static inline void __btnCallEventProc(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn,z_btn_state_t _sta)
+{
+    if (_btn == __BTNREF_NONE) {
+        goto error;
+    }
+    if ((__BTN(_btn,EventMask) & Z_BTNMGR_EVENT_BIT(_sta)) == 0 || __BTN(_btn,Flags).NoResp == 1) {
+        goto feed;
+    }
+#if Z_BTNMGR_BATCH_SIZE > 0
+    // the batch callback has the events of the buttons without callback too
+    if (__BTN(_btn,Event) == 0 && _ctx->BatchEvent == 0) {
+#else
+    if (__BTN(_btn,Event) == 0) {
+#endif
+        goto feed;
+    }
+#if Z_BTNMGR_CHORD_BTNS > 0
+    // a key of a mutex chord that is pressing
+    if (__BTNID(_btn) < Z_BTNMGR_CHORD_BTNS && __CHORD_BIT(_ctx->ChordMutex,__BTNID(_btn)) != 0) {
+        goto feed;
+    }
+#endif
+#if Z_BTNMGR_EDGE_TIME > 0
+    __eventEmit(_ctx,__BTNOBJ(_btn),__BTNEVENT(_btn),_sta,__BTNPASTTIME(_btn,EdgeTime),__BTNARGID(_btn));
+#else
+    __eventEmit(_ctx,__BTNOBJ(_btn),__BTNEVENT(_btn),_sta,_ctx->TickCount,__BTNARGID(_btn));
+#endif
+
+feed:
+    // the key sequences see the events without callback too
+#if Z_BTNMGR_SEQ_NODES > 0
+    __seqFeed(_ctx,__BTNOBJ(_btn),_sta);
+#endif
+error:
+    return;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnReadLevel
+ * @brief  : Read the level of button once,from the port sample or the callback
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ * @return : res   - presing : 1,released : 0
+ */
+static inline uint8_t __btnReadLevel(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    uint8_t res = 0;
+    if (__BTN(_btn,Port) != 0) {
+        res = (uint8_t)((__BTNPORT(_btn)->Value >> __BTN(_btn,PortBit)) & 0x01);
+    }
+    else if (__BTN(_btn,Flags).Edge == 1) {
+        res = __BTN(_btn,Flags).Level;
+    }
+    else {
+        res = __BTNREAD(_btn)();
+    }
+#if Z_BTNMGR_TRACE_SIZE > 0
+    res = __traceLevelProc(_ctx,__BTNID(_btn),res);
+#else
+    (void)_ctx;
+#endif
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnDebounceTime
+ * @brief  : Debounce time of a button,no time debounce when the port
+ *           or the eager / integrator filter did it
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ * @return : res   - time(ticks of the clock)
+ */
+static inline uint32_t __btnDebounceTime(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    uint32_t res = __MS(__BTNTIMING(_btn)->Debounce);
+    (void)_ctx;
+    if (__BTN(_btn,Port) != 0 && __BTNPORT(_btn)->Flags.Debounce == 1) {
+        res = 0;
+    }
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+    if (__BTN(_btn,DebounceMode) != BtnDebounce_Deferred) {
+        res = 0;
+    }
+#endif
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnPressingPeriod
+ * @brief  : Period of the BtnSta_Pressing event while a button is held
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ * @return : res   - time(ticks of the clock)
+ */
+static inline uint32_t __btnPressingPeriod(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    uint32_t res = __BTNTIMING(_btn)->Pressing;
+    (void)_ctx;
+    (void)_btn;
+    if (res == 0) {
+        res = Z_BTNMGR_PRESSING_PERIOD;
+    }
+    return __MS(res);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnFilterLevel
+ * @brief  : Debounce the level of a eager or integrator button,
+ *           the level of a deferred button is not changed
+ * @param  : _ctx    - a button manager
+ *           _btn    - a Button object
+ *           _level  - level read in this tick
+ * @return : res   - level given to the state machine
+ */
+static inline uint8_t __btnFilterLevel(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn,uint8_t _level)
+{
+    uint8_t res = _level;
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+    uint32_t time = __MS(__BTNTIMING(_btn)->Debounce);
+    uint32_t since = 0;
+    uint32_t sum = 0;
+
+    switch (__BTN(_btn,DebounceMode)) {
+    case BtnDebounce_Eager: {
+        if (__BTN(_btn,Flags).Hold == 1 && __TIME_SINCE(__BTNTIME(_btn,FilterTime)) >= time) {
+            __BTN(_btn,Flags).Hold = 0;
+        }
+        // a edge is reported at once, the bounces after it are not seen
+        if (__BTN(_btn,Flags).Hold == 0 && __BTN(_btn,Flags).Filter != _level) {
+            __BTN(_btn,Flags).Filter = _level;
+            __BTN(_btn,Flags).Hold = 1;
+            __BTNSETTIME(_btn,FilterTime,_ctx->TickCount);
+        }
+        res = __BTN(_btn,Flags).Filter;
+    }break;
+    case BtnDebounce_Integrator: {
+        // the level of the last read is held until this read
+        since = __TIME_SINCE(__BTNTIME(_btn,FilterTime));
+        sum = __BTN(_btn,FilterSum);
+        sum = sum < time ? sum : time;
+        if (__BTN(_btn,Flags).Hold == 1) {
+            sum = since < time - sum ? sum + since : time;
+            if (sum == time) {
+                __BTN(_btn,Flags).Filter = 1;
+            }
+        }
+        else {
+            sum = since < sum ? sum - since : 0;
+            if (sum == 0) {
+                __BTN(_btn,Flags).Filter = 0;
+            }
+        }
+        __BTN(_btn,FilterSum) = (z_btntime_t)sum;
+        __BTNSETTIME(_btn,FilterTime,_ctx->TickCount);
+        __BTN(_btn,Flags).Hold = _level;
+        res = __BTN(_btn,Flags).Filter;
+    }break;
+    default:break;
+    }
+#else
+    (void)_ctx;
+    (void)_btn;
+#endif
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnClickEvent
+ * @brief  : Count a click, and returns the event of it by the type of button
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ * @return : res   - event state, BtnSta_None when it waits the next click
+ */
+static inline z_btn_state_t __btnClickEvent(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    z_btn_state_t res = BtnSta_Clicked;
+    (void)_ctx;
+    switch (__BTN(_btn,Type)) {
+    case BtnType_DoubleClicked: {
+        if (__BTN(_btn,Clicks) == 0) {
+            __BTN(_btn,Clicks) = 1;
+            res = BtnSta_None;
+        }
+        else {
+            __BTN(_btn,Clicks) = 0;
+            res = BtnSta_DoubleClicked;
+        }
+    }break;
+    case BtnType_BothClicked: {
+        __BTN(_btn,Clicks)++;
+        if (__BTN(_btn,Clicks) == 2) {
+            res = BtnSta_DoubleClicked;
+        }
+        else if (__BTN(_btn,Clicks) >= 3) {
+            __BTN(_btn,Clicks) = 0;
+            res = BtnSta_TripleClicked;
+        }
+    }break;
+    default:__BTN(_btn,Clicks) = 0;break;
+    }
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnClickTimeout
+ * @brief  : The clicks end, report the click that is waiting
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ * @return : none
+ */
+static inline void __btnClickTimeout(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    if (__BTN(_btn,Type) == BtnType_DoubleClicked) {
+        __btnCallEventProc(_ctx,_btn,BtnSta_Clicked);
+    }
+    __BTN(_btn,Clicks) = 0;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnReleasingProc
+ * @brief  : Event handling of button release status
+ * @param  : _ctx    - a button manager
+ *           _btn    - a Button object
+ *           _level  - level of button in this tick
+ * @return : res   - state of button
+ */
+static inline z_btn_state_t __btnReleasingProc(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn,uint8_t _level)
+{
+    z_btn_state_t res = BtnSta_Releasing;
+    if (_btn == __BTNREF_NONE) {
+        goto error;
+    }
+    // no next click in the double click time
+    if (__BTN(_btn,Clicks) != 0 && __BTNSTARTED(_btn,StartPresseTime) == 0 &&
+        __TIME_SINCE(__BTNTIME(_btn,StartReleaseTime)) >= __MS(__BTNTIMING(_btn)->DoubleClick)) {
+        __btnClickTimeout(_ctx,_btn);
+    }
+    if (_level == 0) {
+        __BTNSTOP(_btn,StartPresseTime);
+        goto error;
+    }
+    if (__BTNSTARTED(_btn,StartPresseTime) == 0) {
+        __BTNSTART(_btn,StartPresseTime);
+    }
+    // the first pressed read is counted as stable
+    if (__TIME_SINCE(__BTNTIME(_btn,StartPresseTime)) + 1 < __btnDebounceTime(_ctx,_btn)) {
+        goto error;
+    }
+    if (_level == 1) {
+        __BTNSTOP(_btn,StartReleaseTime);
+        __BTNSETTIME(_btn,PressTimeBuf,_ctx->TickCount);
+#if Z_BTNMGR_EDGE_TIME > 0
+        __BTNSETTIME(_btn,EdgeTime,__BTNTIME(_btn,StartPresseTime));
+#endif
+        res = BtnSta_Pressing;
+#if Z_BTNMGR_STATS > 0
+        __statsLatencyProc(_ctx,_btn);
+#endif
+        __btnCallEventProc(_ctx,_btn,res);
+    }
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnPressingProc
+ * @brief  : Event handling of button press state
+ * @param  : _ctx    - a button manager
+ *           _btn    - a Button object
+ *           _level  - level of button in this tick
+ * @return : res   - state of button
+ */
+static inline z_btn_state_t __btnPressingProc(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn,uint8_t _level)
+{
+    z_btn_state_t res = BtnSta_Pressing;
+    z_btn_state_t sta = BtnSta_None;
+    const z_btntiming_t* timing = 0;
+    uint32_t debounce = 0;
+    if (_btn == __BTNREF_NONE) {
+        goto error;
+    }
+    timing = __BTNTIMING(_btn);
+    debounce = __btnDebounceTime(_ctx,_btn);
+    // Button release detected
+    if (_level == 0) {
+        if (__BTNSTARTED(_btn,StartReleaseTime) == 0) {
+            __BTNSTART(_btn,StartReleaseTime);
+        }
+        if (__TIME_SINCE(__BTNTIME(_btn,StartReleaseTime)) >= debounce) {
+            res = BtnSta_Clicked;
+#if Z_BTNMGR_EDGE_TIME > 0
+            __BTNSETTIME(_btn,EdgeTime,__BTNTIME(_btn,StartReleaseTime));
+#endif
+            sta = __btnClickEvent(_ctx,_btn);
+            // the time of click, to wait the next click
+            if (__BTN(_btn,Clicks) != 0) {
+                __BTNSTART(_btn,StartReleaseTime);
+            }
+            else {
+                __BTNSTOP(_btn,StartReleaseTime);
+            }
+            if (sta != BtnSta_None) {
+                __btnCallEventProc(_ctx,_btn,sta);
+            }
+            goto error;
+        }
+    }
+    else if (__BTNSTARTED(_btn,StartReleaseTime) == 1 &&
+             __TIME_SINCE(__BTNTIME(_btn,StartReleaseTime)) >= debounce) {
+        __BTNSTOP(_btn,StartReleaseTime);
+    }
+    // btn is Keep pressing
+    if (__BTNSTARTED(_btn,StartPresseTime) == 0) {
+        __BTNSTART(_btn,StartPresseTime);
+    }
+    if (__TIME_SINCE(__BTNTIME(_btn,StartPresseTime)) >= __MS(timing->LongPress)) {
+        __BTNSTOP(_btn,StartReleaseTime);
+        __BTNSETTIME(_btn,PressTimeBuf,__BTNTIME(_btn,StartPresseTime) + __MS(timing->LongPress) + __MS(timing->Repeat));
+#if Z_BTNMGR_REPEAT_ACCEL > 0
+        __BTN(_btn,RepeatPeriod) = timing->Repeat;
+#endif
+        // a long press ends the clicks
+        if (__BTN(_btn,Clicks) != 0) {
+            __btnClickTimeout(_ctx,_btn);
+        }
+        res = BtnSta_LongPressing;
+        __btnCallEventProc(_ctx,_btn,res);
+        goto error;
+    }
+    else if (__TIME_SINCE(__BTNTIME(_btn,PressTimeBuf)) > __btnPressingPeriod(_ctx,_btn)) {
+        __BTNSETTIME(_btn,PressTimeBuf,_ctx->TickCount);
+        __btnCallEventProc(_ctx,_btn,res);
+    }
+    
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnLongPressingProc
+ * @brief  : Handling the event that the button is pressed for a long time
+ * @param  : _ctx    - a button manager
+ *           _btn    - a Button object
+ *           _level  - level of button in this tick
+ * @return : res   - state of button
+ */
+static inline z_btn_state_t __btnLongPressingProc(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn,uint8_t _level)
+{
+    z_btn_state_t res = BtnSta_LongPressing;
+    const z_btntiming_t* timing = 0;
+    uint32_t debounce = 0;
+    uint32_t period = 0;
+#if Z_BTNMGR_REPEAT_ACCEL > 0
+    uint32_t min = 0;
+#endif
+    if (_btn == __BTNREF_NONE) {
+        goto error;
+    }
+    debounce = __btnDebounceTime(_ctx,_btn);
+    // button release detected
+    if (_level == 0) {
+        if (__BTNSTARTED(_btn,StartReleaseTime) == 0) {
+            __BTNSTART(_btn,StartReleaseTime);
+        }
+        if (__TIME_SINCE(__BTNTIME(_btn,StartReleaseTime)) >= debounce) {
+#if Z_BTNMGR_EDGE_TIME > 0
+            __BTNSETTIME(_btn,EdgeTime,__BTNTIME(_btn,StartReleaseTime));
+#endif
+            __BTNSTOP(_btn,StartReleaseTime);
+            res = BtnSta_Pressed;
+            __btnCallEventProc(_ctx,_btn,res);
+            goto error;
+        }
+    }
+    else if (__BTNSTARTED(_btn,StartReleaseTime) == 1 &&
+             __TIME_SINCE(__BTNTIME(_btn,StartReleaseTime)) >= debounce) {
+        __BTNSTOP(_btn,StartReleaseTime);
+    }
+    // btn is Keep pressing
+    // every repeat that is due, also when the tick is late
+    timing = __BTNTIMING(_btn);
+    while (timing->Repeat != 0 &&
+           __TIME_DUE(__BTNTIME(_btn,PressTimeBuf))) {
+#if Z_BTNMGR_REPEAT_ACCEL > 0
+        // the shortest period, at least 1ms
+        min = timing->RepeatMin < timing->Repeat ? timing->RepeatMin : timing->Repeat;
+        min = min != 0 ? min : 1;
+        period = __BTN(_btn,RepeatPeriod);
+        // the profile was changed while the button is held (e.g. Repeat was 0),
+        // the repeats start again from now by the new profile
+        if (period < min || period > timing->Repeat) {
+            __BTN(_btn,RepeatPeriod) = timing->Repeat;
+            __BTNSETTIME(_btn,PressTimeBuf,_ctx->TickCount + __MS(timing->Repeat));
+            break;
+        }
+        // faster after each repeat, down to RepeatMin
+        if (timing->RepeatStep != 0) {
+            period = period > min + timing->RepeatStep ? period - timing->RepeatStep : min;
+            __BTN(_btn,RepeatPeriod) = (uint16_t)period;
+        }
+#else
+        period = timing->Repeat;
+#endif
+        __BTNSETTIME(_btn,PressTimeBuf,__BTNTIME(_btn,PressTimeBuf) + __MS(period));
+        __btnCallEventProc(_ctx,_btn, BtnSta_LongPressed_Repeat);
+    }
+    
 error:
     return res;
 }
@@ -402,19 +3349,22 @@ error:
 /**-------------------------------------------------------------------
  * @fn     : __btnPressedOrClickedProc
  * @brief  : Event handling of button click completed
- * @param  : _btn  - a Button object
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
  * @return : res  - state of button
  */
-static inline z_btn_state_t __btnPressedOrClickedProc(z_btn_t* _btn)
+static inline z_btn_state_t __btnPressedOrClickedProc(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
 {
     z_btn_state_t res = BtnSta_Releasing;
-    if (_btn == 0 || _btn->ClickAction == 0) {
+    if (_btn == __BTNREF_NONE) {
         goto error;
     }
-    _btn->StartReleaseTime = 0;
-    _btn->StartPresseTime = 0;
-    _btn->PreState = BtnSta_Pressed;
-    __btnCallEventProc(_btn,res);
+    if (__BTN(_btn,Clicks) == 0) {
+        __BTNSTOP(_btn,StartReleaseTime);
+    }
+    __BTNSTOP(_btn,StartPresseTime);
+    __BTN(_btn,Flags).Pressed = 1;
+    __btnCallEventProc(_ctx,_btn,res);
 error:
     return res;
 }
@@ -422,65 +3372,511 @@ error:
 /**-------------------------------------------------------------------
  * @fn     : z_btnmgr_btnProc
  * @brief  : Button handling function
- * @param  : _btn  - a Button object
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
  * @return : none
  */
-inline void z_btnmgr_btnProc(z_btn_t* _btn)
+inline void z_btnmgr_btnProc(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
 {
-    if (_btn == 0 || _btn->ClickAction == 0) {
+    uint8_t level = 0;
+    if (_btn == __BTNREF_NONE || __btnHasInput(_ctx,_btn) == false) {
         goto error;
     }
-    switch (_btn->State) {
+    switch (__BTN(_btn,State)) {
     case BtnSta_Releasing: {
-        _btn->State = __btnReleasingProc(_btn);
+        level = __btnFilterLevel(_ctx,_btn,__btnReadLevel(_ctx,_btn));
+        __BTN(_btn,State) = __btnReleasingProc(_ctx,_btn,level);
     }break;
     case BtnSta_Pressing: {
-        _btn->State = __btnPressingProc(_btn);
+        level = __btnFilterLevel(_ctx,_btn,__btnReadLevel(_ctx,_btn));
+        __BTN(_btn,State) = __btnPressingProc(_ctx,_btn,level);
     }break;
     case BtnSta_LongPressing: {
-        _btn->State = __btnLongPressingProc(_btn);
+        level = __btnFilterLevel(_ctx,_btn,__btnReadLevel(_ctx,_btn));
+        __BTN(_btn,State) = __btnLongPressingProc(_ctx,_btn,level);
     }break;
     case BtnSta_Clicked: 
     case BtnSta_Pressed: {
-        _btn->State = __btnPressedOrClickedProc(_btn);
+        __BTN(_btn,State) = __btnPressedOrClickedProc(_ctx,_btn);
     }break;
-    default:_btn->State = BtnSta_Releasing;break;
+    default:__BTN(_btn,State) = BtnSta_Releasing;break;
+    }
+#if Z_BTNMGR_CHORD_BTNS > 0
+    __chordKeyProc(_ctx,__BTNID(_btn),__BTN(_btn,State) == BtnSta_Pressing ||
+                                      __BTN(_btn,State) == BtnSta_LongPressing);
+#endif
+
+error:
+    return;
+}
+
+#if Z_BTNMGR_MAX_BTNS > 0
+/**-------------------------------------------------------------------
+ * @fn     : __btnIsIdle
+ * @brief  : Returns whether the button can leave the active set.
+ *           It is released with nothing to wait, and its level
+ *           is not read by a callback.
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ * @return : res   - ture when it is idle
+ */
+static inline uint8_t __btnIsIdle(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    uint8_t res = false;
+    if (__BTN(_btn,State) == BtnSta_Releasing &&
+        __BTNSTARTED(_btn,StartPresseTime) == 0 &&
+        __BTN(_btn,Clicks) == 0 &&
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+        __BTN(_btn,Flags).Hold == 0 &&
+        __BTN(_btn,FilterSum) == 0 &&
+#endif
+        __BTN(_btn,ClickAction) == 0 &&
+        __btnReadLevel(_ctx,_btn) == 0) {
+        res = true;
+    }
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __bitLowest
+ * @brief  : Index of the lowest bit that is set
+ * @param  : _val  - a value that is not 0
+ * @return : res   - index of bit
+ */
+static inline uint8_t __bitLowest(uint32_t _val)
+{
+#if defined(__GNUC__)
+    return (uint8_t)__builtin_ctz(_val);
+#else
+    uint8_t res = 0;
+    while ((_val & 0x01) == 0) {
+        _val >>= 1;
+        res++;
+    }
+    return res;
+#endif
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __poolPortBtns
+ * @brief  : Find the registered buttons of every port bit again,
+ *           after a button or a port was registered or created
+ * @param  : _ctx  - a button manager
+ * @return : none
+ */
+static void __poolPortBtns(z_btnmgr_ctx_t* _ctx)
+{
+    uint16_t id = 0;
+    z_btnport_t* port_p = 0;
+    for (id = 0; id < _ctx->Pool.Count; id++) {
+        port_p = __BTNPORT(id);
+        if (port_p != 0) {
+            port_p->BitBtn[_ctx->Pool.PortBit[id]] = __BTNREF_NONE;
+        }
+    }
+    for (id = _ctx->Pool.Count; id-- > 0;) {
+        port_p = __BTNPORT(id);
+        if (port_p != 0 && _ctx->Pool.Flags[id].Reg == 1) {
+#if Z_BTNMGR_COMPACT > 0
+            // no list of the buttons of a bit, the wake finds them in the pool
+            if (port_p->BitBtn[_ctx->Pool.PortBit[id]] != __BTNREF_NONE) {
+                port_p->BitBtn[_ctx->Pool.PortBit[id]] = __BTNREF_MANY;
+                continue;
+            }
+#else
+            _ctx->Pool.PortNext[id] = port_p->BitBtn[_ctx->Pool.PortBit[id]];
+#endif
+            port_p->BitBtn[_ctx->Pool.PortBit[id]] = id;
+        }
+    }
+    _ctx->PortBtnsChanged = false;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __poolWakePort
+ * @brief  : Put the buttons of the bits of a port that changed in this
+ *           tick into the active set, the other buttons are not read
+ * @param  : _ctx   - a button manager
+ *           _port  - a input port, Changed is not 0
+ * @return : none
+ */
+static void __poolWakePort(z_btnmgr_ctx_t* _ctx,z_btnport_t* _port)
+{
+    uint16_t id = 0;
+    uint8_t low = 0;
+    uint8_t bit = 0;
+    uint32_t bits = 0;
+    if (_ctx->PortBtnsChanged == true) {
+        __poolPortBtns(_ctx);
+    }
+    for (low = 0; low < Z_BTNMGR_PORT_WIDTH; low += 32) {
+        bits = (uint32_t)(_port->Changed >> low);
+        while (bits != 0) {
+            bit = (uint8_t)(low + __bitLowest(bits));
+            id = _port->BitBtn[bit];
+            bits &= bits - 1;
+#if Z_BTNMGR_COMPACT > 0
+            if (id == __BTNREF_MANY) {
+                for (id = 0; id < _ctx->Pool.Count; id++) {
+                    if (__BTNPORT(id) == _port && _ctx->Pool.PortBit[id] == bit &&
+                        _ctx->Pool.Flags[id].Reg == 1) {
+                        __POOL_SETACTIVE(_ctx,id);
+                    }
+                }
+            }
+            else if (id != __BTNREF_NONE) {
+                __POOL_SETACTIVE(_ctx,id);
+            }
+#else
+            while (id != __BTNREF_NONE) {
+                __POOL_SETACTIVE(_ctx,id);
+                id = _ctx->Pool.PortNext[id];
+            }
+#endif
+        }
+    }
+}
+
+#if Z_BTNMGR_WHEEL_BITS > 0
+/**-------------------------------------------------------------------
+ * @fn     : __wheelAdd
+ * @brief  : Put a button in the slot of the wheel of its time.
+ *           A time past the 2nd level waits in the last slot of it,
+ *           and is put again when the slot is reached.
+ * @param  : _ctx   - a button manager
+ *           _id    - id of button
+ *           _time  - tick count to handle the button
+ * @return : none
+ */
+static void __wheelAdd(z_btnmgr_ctx_t* _ctx,uint16_t _id,uint32_t _time)
+{
+    uint32_t delta = _time - _ctx->WheelNow;
+    uint32_t slot = 0;
+    uint16_t head = 0;
+
+    // due now, or already past
+    if (delta == 0 || delta > 0x7FFFFFFFUL) {
+        __POOL_SETACTIVE(_ctx,_id);
+        goto error;
+    }
+    if (delta < Z_BTNMGR_WHEEL_SLOTS) {
+        slot = _time & __WHEEL_MASK;
+    }
+    else {
+        // slots of the 2nd level, also when the tick count wraps
+        delta = ((_time >> Z_BTNMGR_WHEEL_BITS) - (_ctx->WheelNow >> Z_BTNMGR_WHEEL_BITS)) &
+                (0xFFFFFFFFUL >> Z_BTNMGR_WHEEL_BITS);
+        if (delta > __WHEEL_MASK) {
+            delta = __WHEEL_MASK;
+        }
+        slot = Z_BTNMGR_WHEEL_SLOTS + (((_ctx->WheelNow >> Z_BTNMGR_WHEEL_BITS) + delta) & __WHEEL_MASK);
     }
+    head = _ctx->Wheel[slot];
+    _ctx->Pool.WheelTime[_id] = (z_btntime_t)_time;
+    _ctx->Pool.WheelSlot[_id] = (uint8_t)slot;
+    _ctx->Pool.WheelPrev[_id] = __BTNREF_NONE;
+    _ctx->Pool.WheelNext[_id] = head;
+    if (head != __BTNREF_NONE) {
+        _ctx->Pool.WheelPrev[head] = _id;
+    }
+    _ctx->Wheel[slot] = _id;
+    _ctx->WheelBits[slot >> 5] |= 1UL << (slot & 0x1F);
+    _ctx->WheelNum++;
 
 error:
     return;
 }
 
+/**-------------------------------------------------------------------
+ * @fn     : __wheelDel
+ * @brief  : Take a button out of the wheel
+ * @param  : _ctx  - a button manager
+ *           _id   - id of button, in the wheel
+ * @return : none
+ */
+static void __wheelDel(z_btnmgr_ctx_t* _ctx,uint16_t _id)
+{
+    uint16_t prev = _ctx->Pool.WheelPrev[_id];
+    uint16_t next = _ctx->Pool.WheelNext[_id];
+    if (prev != __BTNREF_NONE) {
+        _ctx->Pool.WheelNext[prev] = next;
+    }
+    else {
+        _ctx->Wheel[_ctx->Pool.WheelSlot[_id]] = next;
+        if (next == __BTNREF_NONE) {
+            __WHEEL_CLEAR(_ctx,_ctx->Pool.WheelSlot[_id]);
+        }
+    }
+    if (next != __BTNREF_NONE) {
+        _ctx->Pool.WheelPrev[next] = prev;
+    }
+    _ctx->Pool.WheelSlot[_id] = __WHEEL_NONE;
+    _ctx->WheelNum--;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __wheelNext
+ * @brief  : Slots from a slot of a level of the wheel to the next
+ *           one that has a button, by the bits of the slots
+ * @param  : _ctx    - a button manager
+ *           _level  - first slot of the level, 0 or Z_BTNMGR_WHEEL_SLOTS
+ *           _from   - a slot of the level, 0 to Z_BTNMGR_WHEEL_SLOTS - 1
+ * @return : res   - 1 to Z_BTNMGR_WHEEL_SLOTS, 0 when the level is empty
+ */
+static uint32_t __wheelNext(z_btnmgr_ctx_t* _ctx,uint32_t _level,uint32_t _from)
+{
+    uint32_t res = 1;
+    uint32_t pos = 0;
+    uint32_t slot = 0;
+    uint32_t bits = 0;
+    uint32_t num = 0;
+
+    while (res <= Z_BTNMGR_WHEEL_SLOTS) {
+        pos = (_from + res) & __WHEEL_MASK;
+        slot = _level + pos;
+        bits = _ctx->WheelBits[slot >> 5] >> (slot & 0x1F);
+        // the slots of this word, up to the end of the level
+        num = 32 - (slot & 0x1F);
+        if (num >= Z_BTNMGR_WHEEL_SLOTS - pos) {
+            num = Z_BTNMGR_WHEEL_SLOTS - pos;
+            bits &= 0xFFFFFFFFUL >> (32 - num);
+        }
+        if (bits != 0) {
+            res += __bitLowest(bits);
+            goto error;
+        }
+        res += num;
+    }
+    res = 0;
+
+error:
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __wheelProc
+ * @brief  : Run the wheel to the tick count, the buttons of the slots
+ *           passed go back to the active set. It goes from one slot
+ *           with buttons to the next, so a late tick costs the slots
+ *           with buttons, not the time passed.
+ * @param  : _ctx  - a button manager
+ * @return : none
+ */
+static void __wheelProc(z_btnmgr_ctx_t* _ctx)
+{
+    uint16_t id = 0;
+    uint16_t next = 0;
+    uint32_t slot = 0;
+    uint32_t step = 0;
+    uint32_t buf = 0;
+    uint32_t block = 0;
+
+    while (_ctx->WheelNum != 0 && _ctx->WheelNow != _ctx->TickCount) {
+        // the next slot of the 1st level with a button
+        step = __wheelNext(_ctx,0,_ctx->WheelNow & __WHEEL_MASK);
+        step = step != 0 ? step : 0xFFFFFFFFUL;
+        // the start of the next slot of the 2nd level with a button
+        block = _ctx->WheelNow >> Z_BTNMGR_WHEEL_BITS;
+        buf = __wheelNext(_ctx,Z_BTNMGR_WHEEL_SLOTS,block & __WHEEL_MASK);
+        if (buf != 0) {
+            buf = ((block + buf) << Z_BTNMGR_WHEEL_BITS) - _ctx->WheelNow;
+            step = buf < step ? buf : step;
+        }
+        // nothing before the tick count
+        if (step > _ctx->TickCount - _ctx->WheelNow) {
+            break;
+        }
+        _ctx->WheelNow += step;
+        // a new slot of the 2nd level, its buttons go to the 1st level
+        if ((_ctx->WheelNow & __WHEEL_MASK) == 0) {
+            slot = Z_BTNMGR_WHEEL_SLOTS + ((_ctx->WheelNow >> Z_BTNMGR_WHEEL_BITS) & __WHEEL_MASK);
+            id = _ctx->Wheel[slot];
+            __WHEEL_CLEAR(_ctx,slot);
+            while (id != __BTNREF_NONE) {
+                next = _ctx->Pool.WheelNext[id];
+                _ctx->Pool.WheelSlot[id] = __WHEEL_NONE;
+                _ctx->WheelNum--;
+                // the time is after the start of this slot, in the bits of z_btntime_t
+                __wheelAdd(_ctx,id,_ctx->WheelNow + (z_btntime_t)(_ctx->Pool.WheelTime[id] - (z_btntime_t)_ctx->WheelNow));
+                id = next;
+            }
+        }
+        slot = _ctx->WheelNow & __WHEEL_MASK;
+        id = _ctx->Wheel[slot];
+        __WHEEL_CLEAR(_ctx,slot);
+        while (id != __BTNREF_NONE) {
+            _ctx->Pool.WheelSlot[id] = __WHEEL_NONE;
+            _ctx->WheelNum--;
+            __POOL_SETACTIVE(_ctx,id);
+            id = _ctx->Pool.WheelNext[id];
+        }
+    }
+    _ctx->WheelNow = _ctx->TickCount;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __wheelSleep
+ * @brief  : Put a button that only waits for a time in the wheel.
+ *           A change of its bit wakes it before the time.
+ * @param  : _ctx  - a button manager
+ *           _id   - id of button, handled in this tick
+ *           _sta  - state of button before it was handled
+ * @return : res   - ture when it leaves the active set
+ */
+static inline uint8_t __wheelSleep(z_btnmgr_ctx_t* _ctx,uint16_t _id,uint8_t _sta)
+{
+    uint8_t res = false;
+    uint32_t time = 0;
+    // the level of a callback is only known by reading it
+    if (_ctx->Pool.ClickAction[_id] != 0) {
+        goto error;
+    }
+    // a new state has not seen the level yet, the state before may
+    // have dropped it (e.g. a release that starts in the long press tick)
+    if (_sta != _ctx->Pool.State[_id]) {
+        goto error;
+    }
+    time = __btnDeadline(_ctx,_id);
+    if (time == 0) {
+        goto error;
+    }
+    // nothing to wait but the level
+    if (time != Z_BTNMGR_DEADLINE_NONE) {
+        __wheelAdd(_ctx,_id,_ctx->TickCount + time);
+    }
+    res = true;
+
+error:
+    return res;
+}
+#endif
+
+/**-------------------------------------------------------------------
+ * @fn     : __poolActiveProc
+ * @brief  : Handle the buttons in the active set, and remove the
+ *           buttons that become idle
+ * @param  : _ctx  - a button manager
+ * @return : none
+ */
+static void __poolActiveProc(z_btnmgr_ctx_t* _ctx)
+{
+    uint16_t i = 0;
+    uint16_t id = 0;
+    uint8_t n = 0;
+    uint32_t bits = 0;
+#if Z_BTNMGR_WHEEL_BITS > 0
+    uint8_t sta = 0;
+#endif
+    for (i = 0; i < Z_BTNMGR_ACTIVE_WORDS; i++) {
+        bits = _ctx->Pool.Active[i];
+        while (bits != 0) {
+            n = __bitLowest(bits);
+            bits &= bits - 1;
+            id = (uint16_t)((i << 5) + n);
+#if Z_BTNMGR_WHEEL_BITS > 0
+            sta = _ctx->Pool.State[id];
+#endif
+            z_btnmgr_btnProc(_ctx,id);
+#if Z_BTNMGR_WHEEL_BITS > 0
+            // woken before its time
+            if (_ctx->Pool.WheelSlot[id] != __WHEEL_NONE) {
+                __wheelDel(_ctx,id);
+            }
+            if (__btnIsIdle(_ctx,id) == true || __wheelSleep(_ctx,id,sta) == true) {
+                _ctx->Pool.Active[i] &= ~(1UL << n);
+            }
+#else
+            if (__btnIsIdle(_ctx,id) == true) {
+                _ctx->Pool.Active[i] &= ~(1UL << n);
+            }
+#endif
+        }
+    }
+}
+#endif
+
+#if Z_BTNMGR_MAX_BTNS > 0
+/**-------------------------------------------------------------------
+ * @fn     : __grpNext
+ * @brief  : Next button of a group, in the pool
+ * @param  : _ctx    - a button manager
+ *           _group  - a Button group
+ *           _id     - id of button, __BTNREF_NONE for the first one
+ * @return : res   - id of the next button, __BTNREF_NONE after the last one
+ */
+static inline uint16_t __grpNext(z_btnmgr_ctx_t* _ctx,z_btngroup_t* _group,uint16_t _id)
+{
+#if Z_BTNMGR_COMPACT > 0
+    uint32_t start = _id == __BTNREF_NONE ? 0 : (uint32_t)_id + 1;
+    uint32_t word = start >> 5;
+    uint32_t bits = 0;
+    uint16_t res = __BTNREF_NONE;
+    (void)_ctx;
+    if (word >= Z_BTNMGR_ACTIVE_WORDS) {
+        goto error;
+    }
+    bits = _group->Btns[word] & (0xFFFFFFFFUL << (start & 0x1F));
+    while (bits == 0 && ++word < Z_BTNMGR_ACTIVE_WORDS) {
+        bits = _group->Btns[word];
+    }
+    if (bits != 0) {
+        res = (uint16_t)((word << 5) + __bitLowest(bits));
+    }
+
+error:
+    return res;
+#else
+    return _id == __BTNREF_NONE ? _group->BtnsHead : __BTN(_id,GroupNext);
+#endif
+}
+#endif
+
 /**-------------------------------------------------------------------
  * @fn     : z_btnmgr_grpStaChg
  * @brief  : Change the state of the button sets and change the properties of the sub-buttons
  * @param  : _group  - a Button group
  * @return : none
  */
-static inline void __grpStaChg(z_btngroup_t* _group)
+static inline void __grpStaChg(z_btnmgr_ctx_t* _ctx,z_btngroup_t* _group)
 {
+#if Z_BTNMGR_MAX_BTNS > 0
+    uint16_t id = 0;
+#else
     z_blist_t* blist_pbuf = &_group->BtnsList;
     z_btn_t* btn_p = 0;
+    (void)_ctx;
+#endif
     switch (_group->Property) {
         case BrnGrpProp_None:
         case BrnGrpProp_Parallel: {
 
         }break;
         case BrnGrpProp_Mutex: {
+#if Z_BTNMGR_MAX_BTNS > 0
+            for (id = __grpNext(_ctx,_group,__BTNREF_NONE); id != __BTNREF_NONE; id = __grpNext(_ctx,_group,id)) {
+                if (_group->State == BtnSta_Pressing) {
+                    __BTN(id,Flags).NoResp = 1;
+                }
+                else {
+                    __BTN(id,Flags).NoResp = 0;
+                }
+            }
+#else
             while (blist_pbuf->NextNode != &_group->BtnsList)
             {
                 btn_p = LIST_FIRST_ENTRY(blist_pbuf,
                                         z_btn_t*,
                                         List);
                 if (_group->State == BtnSta_Pressing) {
-                    btn_p->Flags.NoResp = 1;
+                    __HBTN(btn_p,Flags).NoResp = 1;
                 }
                 else {
-                    btn_p->Flags.NoResp = 0;
+                    __HBTN(btn_p,Flags).NoResp = 0;
                 }
 
                 blist_pbuf = blist_pbuf->NextNode;
             }
+#endif
 
         }break;
         default:break;
@@ -490,25 +3886,39 @@ static inline void __grpStaChg(z_btngroup_t* _group)
  /**-------------------------------------------------------------------
  * @fn     : z_btnmgr_groupProc
  * @brief  : Button group handling function
- * @param  : _group  - a Button group
+ * @param  : _ctx    - a button manager
+ *           _group  - a Button group
  * @return : none
  */
-inline void z_btnmgr_groupProc(z_btngroup_t* _group)
+inline void z_btnmgr_groupProc(z_btnmgr_ctx_t* _ctx,z_btngroup_t* _group)
 {
-    z_blist_t* blist_pbuf = &_group->BtnsList;
+#if Z_BTNMGR_MAX_BTNS > 0
+    uint16_t id = 0;
+#else
+    z_blist_t* blist_pbuf = 0;
+    z_btn_t* btn_p = 0;
+#endif
     uint8_t btncount = 0;
     uint8_t btnpress = 0;
-    z_btn_t* btn_p = 0;
-    z_btn_args_t args;
     if (_group == 0) {
         goto error;
     }
+#if Z_BTNMGR_MAX_BTNS > 0
+    // the buttons are handled with the pool
+    for (id = __grpNext(_ctx,_group,__BTNREF_NONE); id != __BTNREF_NONE; id = __grpNext(_ctx,_group,id)) {
+        btncount++;
+        if (__BTN(id,State) == BtnSta_Pressing || __BTN(id,State) == BtnSta_LongPressing) {
+            btnpress++;
+        }
+    }
+#else
+    blist_pbuf = &_group->BtnsList;
     while (blist_pbuf->NextNode != &_group->BtnsList)
     {
         btn_p = LIST_FIRST_ENTRY(blist_pbuf,
                                   z_btn_t*,
                                   List);
-        z_btnmgr_btnProc(btn_p);
+        z_btnmgr_btnProc(_ctx,btn_p);
         blist_pbuf = blist_pbuf->NextNode;
 
         //
@@ -517,27 +3927,549 @@ inline void z_btnmgr_groupProc(z_btngroup_t* _group)
             btnpress++;
         }
     }
+#endif
     if (_group->Event != 0 && btncount != 0) {
         if (btncount == btnpress) {
             _group->State = BtnSta_Pressing;
-            __grpStaChg(_group);
+            __grpStaChg(_ctx,_group);
         }
         else if (_group->State == BtnSta_Pressing && btnpress == 0) {
             _group->State = BtnSta_Clicked;
         }
         else if(_group->State == BtnSta_Clicked && btnpress == 0){
             _group->State = BtnSta_Releasing;
-            __grpStaChg(_group);
+            __grpStaChg(_ctx,_group);
         }
         else {
             goto error;
         }
-        args.Obj = _group;
-        args.State = _group->State;
-        _group->Event(args);
+        __eventEmit(_ctx,_group,_group->Event,_group->State,_ctx->TickCount,Z_BTNMGR_ID_NONE);
+#if Z_BTNMGR_SEQ_NODES > 0
+        __seqFeed(_ctx,_group,_group->State);
+#endif
     }
 error:
     return;
 }
 
+/**-------------------------------------------------------------------
+ * @fn     : __timeLeft
+ * @brief  : Time from now to a tick count,0 when it is due
+ * @param  : _ctx   - a button manager
+ *           _time  - a tick count
+ * @return : res   - time(ticks of the clock)
+ */
+static inline uint32_t __timeLeft(z_btnmgr_ctx_t* _ctx,uint32_t _time)
+{
+    uint32_t res = _time - _ctx->TickCount;
+    // due now, or already past
+    if (res > 0x7FFFFFFFUL) {
+        res = 0;
+    }
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnFilterDeadline
+ * @brief  : Time until the eager or integrator filter of a button
+ *           may change its level, with the level read before
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ * @return : res   - time(ticks of the clock) , Z_BTNMGR_DEADLINE_NONE when it can not
+ */
+static inline uint32_t __btnFilterDeadline(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    uint32_t res = Z_BTNMGR_DEADLINE_NONE;
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+    uint32_t time = __MS(__BTNTIMING(_btn)->Debounce);
+    uint32_t sum = __BTN(_btn,FilterSum);
+    sum = sum < time ? sum : time;
+
+    switch (__BTN(_btn,DebounceMode)) {
+    case BtnDebounce_Eager: {
+        if (__BTN(_btn,Flags).Hold == 1) {
+            res = __timeLeft(_ctx,__BTNTIME(_btn,FilterTime) + time);
+        }
+    }break;
+    case BtnDebounce_Integrator: {
+        if (__BTN(_btn,Flags).Hold == 1 && __BTN(_btn,Flags).Filter == 0) {
+            res = __timeLeft(_ctx,__BTNTIME(_btn,FilterTime) + time - sum);
+        }
+        else if (__BTN(_btn,Flags).Hold == 0 && sum != 0) {
+            res = __timeLeft(_ctx,__BTNTIME(_btn,FilterTime) + sum);
+        }
+    }break;
+    default:break;
+    }
+#else
+    (void)_ctx;
+    (void)_btn;
+#endif
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : __btnDeadline
+ * @brief  : Time until the state machine of a button has something to do,
+ *           the change of level is not included
+ * @param  : _ctx  - a button manager
+ *           _btn  - a Button object
+ * @return : res   - time(ticks of the clock) , Z_BTNMGR_DEADLINE_NONE when it is idle
+ */
+static uint32_t __btnDeadline(z_btnmgr_ctx_t* _ctx,z_btnref_t _btn)
+{
+    uint32_t res = Z_BTNMGR_DEADLINE_NONE;
+    uint32_t buf = 0;
+    uint32_t debounce = __btnDebounceTime(_ctx,_btn);
+
+    switch (__BTN(_btn,State)) {
+    case BtnSta_Releasing: {
+        if (__BTNSTARTED(_btn,StartPresseTime) == 1) {
+            res = __timeLeft(_ctx,__BTNTIME(_btn,StartPresseTime) + debounce - 1);
+        }
+        else if (__BTN(_btn,Clicks) != 0) {
+            res = __timeLeft(_ctx,__BTNTIME(_btn,StartReleaseTime) + __MS(__BTNTIMING(_btn)->DoubleClick));
+        }
+    }break;
+    case BtnSta_Pressing: {
+        res = __timeLeft(_ctx,__BTNTIME(_btn,PressTimeBuf) + __btnPressingPeriod(_ctx,_btn) + 1);
+        buf = __timeLeft(_ctx,__BTNTIME(_btn,StartPresseTime) + __MS(__BTNTIMING(_btn)->LongPress));
+        res = buf < res ? buf : res;
+    }break;
+    case BtnSta_LongPressing: {
+        if (__BTNTIMING(_btn)->Repeat != 0) {
+            res = __timeLeft(_ctx,__BTNTIME(_btn,PressTimeBuf));
+        }
+    }break;
+    default:res = 0;break;
+    }
+    if (__BTNSTARTED(_btn,StartReleaseTime) == 1 &&
+        (__BTN(_btn,State) == BtnSta_Pressing || __BTN(_btn,State) == BtnSta_LongPressing)) {
+        buf = __timeLeft(_ctx,__BTNTIME(_btn,StartReleaseTime) + debounce);
+        res = buf < res ? buf : res;
+    }
+    buf = __btnFilterDeadline(_ctx,_btn);
+    res = buf < res ? buf : res;
+
+    return res;
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_ctxNextDeadline
+ * @brief  : Time until z_btnmgr_tick must be called again.
+ *           While it is Z_BTNMGR_DEADLINE_NONE, all buttons are idle,
+ *           the MCU can sleep until a pin changes, then call
+ *           z_btnmgr_tick with the time slept. While a port is
+ *           debounced it is Z_BTNMGR_SAMPLE_MS at most.
+ * @param  : _ctx  - a button manager
+ * @return : res   - time(ticks of the clock) , Z_BTNMGR_DEADLINE_NONE when all are idle
+ */
+uint32_t z_btnmgr_ctxNextDeadline(z_btnmgr_ctx_t* _ctx)
+{
+    uint32_t res = Z_BTNMGR_DEADLINE_NONE;
+    uint32_t buf = 0;
+    uint32_t sample = __MS(Z_BTNMGR_SAMPLE_MS);
+    z_blist_t *blist_pbuf = &_ctx->Ports_BListHead;
+#if Z_BTNMGR_MAX_BTNS > 0
+    uint16_t id = 0;
+#else
+    z_blist_t *btnlist_pbuf = 0;
+#endif
+    z_btnport_t* port_p = 0;
+    z_btnmatrix_t* matrix_p = 0;
+    z_btnladder_t* ladder_p = 0;
+    z_btnshift_t* shift_p = 0;
+    z_btngroup_t* group_p = 0;
+    uint16_t i = 0;
+
+#if Z_BTNMGR_EDGE_QUEUE_SIZE > 0
+    // edges are waiting
+    if (_ctx->EdgeTail != _ctx->EdgeHead) {
+        res = 0;
+    }
+#endif
+    // a bit is being debounced, the next sample is due after the sample time
+    while (blist_pbuf->NextNode != &_ctx->Ports_BListHead)
+    {
+        port_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                  z_btnport_t*,
+                                  List);
+        if ((port_p->Cnt0 | port_p->Cnt1) != 0) {
+            res = sample < res ? sample : res;
+        }
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    blist_pbuf = &_ctx->Matrix_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->Matrix_BListHead)
+    {
+        matrix_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                    z_btnmatrix_t*,
+                                    List);
+        // the ghost rows are scanned again until the ghost is gone
+        if (matrix_p->GhostRows != 0) {
+            res = sample < res ? sample : res;
+        }
+        for (i = 0; i < matrix_p->RowNum; i++) {
+            if ((matrix_p->Rows[i].Cnt0 | matrix_p->Rows[i].Cnt1) != 0) {
+                res = sample < res ? sample : res;
+            }
+        }
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    blist_pbuf = &_ctx->Ladder_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->Ladder_BListHead)
+    {
+        ladder_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                    z_btnladder_t*,
+                                    List);
+        if ((ladder_p->Port.Cnt0 | ladder_p->Port.Cnt1) != 0) {
+            res = sample < res ? sample : res;
+        }
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    blist_pbuf = &_ctx->Shift_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->Shift_BListHead)
+    {
+        shift_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                   z_btnshift_t*,
+                                   List);
+        for (i = 0; i < Z_BTNMGR_SHIFT_PORTS(shift_p->Len); i++) {
+            if ((shift_p->Ports[i].Cnt0 | shift_p->Ports[i].Cnt1) != 0) {
+                res = sample < res ? sample : res;
+            }
+        }
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    // One Button
+#if Z_BTNMGR_MAX_BTNS > 0
+    // the buttons out of the active set are idle, or wait in the wheel
+    for (id = 0; id < _ctx->Pool.Count; id++) {
+        if ((_ctx->Pool.Active[id >> 5] & (1UL << (id & 0x1F))) != 0
+#if Z_BTNMGR_WHEEL_BITS > 0
+            || _ctx->Pool.WheelSlot[id] != __WHEEL_NONE
+#endif
+            ) {
+            buf = __btnDeadline(_ctx,id);
+            res = buf < res ? buf : res;
+        }
+    }
+#else
+    blist_pbuf = &_ctx->Btns_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->Btns_BListHead)
+    {
+        buf = __btnDeadline(_ctx,LIST_FIRST_ENTRY(blist_pbuf,
+                                             z_btn_t*,
+                                             List));
+        res = buf < res ? buf : res;
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+#endif
+    // Button Group
+    blist_pbuf = &_ctx->BtnGrounp_BListHead;
+    while (blist_pbuf->NextNode != &_ctx->BtnGrounp_BListHead)
+    {
+        group_p = LIST_FIRST_ENTRY(blist_pbuf,
+                                   z_btngroup_t*,
+                                   List);
+        if (group_p->State == BtnSta_Clicked) {
+            res = 0;
+        }
+#if Z_BTNMGR_MAX_BTNS == 0
+        btnlist_pbuf = &group_p->BtnsList;
+        while (btnlist_pbuf->NextNode != &group_p->BtnsList)
+        {
+            buf = __btnDeadline(_ctx,LIST_FIRST_ENTRY(btnlist_pbuf,
+                                                 z_btn_t*,
+                                                 List));
+            res = buf < res ? buf : res;
+            btnlist_pbuf = btnlist_pbuf->NextNode;
+        }
+#endif
+        blist_pbuf = blist_pbuf->NextNode;
+    }
+    return res;
+}
+
+// DEFAULT MANAGER -----------------------------------------------------------
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_init
+ * @brief  : z_btnmgr_ctxInit of the default button manager
+ * @param  : none
+ * @return : none
+ */
+void z_btnmgr_init(void)
+{
+    z_btnmgr_ctxInit(base);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_creategBtn
+ * @brief  : z_btnmgr_ctxCreategBtn of the default button manager
+ * @param  : see z_btnmgr_ctxCreategBtn
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_creategBtn(z_btn_t* _btn,z_readbtn_cb _readbtn, z_click_event _event)
+{
+    return z_btnmgr_ctxCreategBtn(base,_btn,_readbtn,_event);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_regPort
+ * @brief  : z_btnmgr_ctxRegPort of the default button manager
+ * @param  : see z_btnmgr_ctxRegPort
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_regPort(z_btnport_t* _port,z_readport_cb _readport)
+{
+    return z_btnmgr_ctxRegPort(base,_port,_readport);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_createPortBtn
+ * @brief  : z_btnmgr_ctxCreatePortBtn of the default button manager
+ * @param  : see z_btnmgr_ctxCreatePortBtn
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_createPortBtn(z_btn_t* _btn,z_btnport_t* _port,uint8_t _bit,z_click_event _event)
+{
+    return z_btnmgr_ctxCreatePortBtn(base,_btn,_port,_bit,_event);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_createEdgeBtn
+ * @brief  : z_btnmgr_ctxCreateEdgeBtn of the default button manager
+ * @param  : see z_btnmgr_ctxCreateEdgeBtn
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_createEdgeBtn(z_btn_t* _btn,uint8_t _level,z_click_event _event)
+{
+    return z_btnmgr_ctxCreateEdgeBtn(base,_btn,_level,_event);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_getTickCount
+ * @brief  : z_btnmgr_ctxGetTickCount of the default button manager
+ * @param  : none
+ * @return : res  - time(ticks of the clock)
+ */
+uint32_t z_btnmgr_getTickCount(void)
+{
+    return z_btnmgr_ctxGetTickCount(base);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_regMatrix
+ * @brief  : z_btnmgr_ctxRegMatrix of the default button manager
+ * @param  : see z_btnmgr_ctxRegMatrix
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_regMatrix(z_btnmatrix_t* _matrix,z_btnport_t* _rows,uint8_t _rownum,
+                           z_driverow_cb _driverow,z_readport_cb _readcols)
+{
+    return z_btnmgr_ctxRegMatrix(base,_matrix,_rows,_rownum,_driverow,_readcols);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_createMatrixBtn
+ * @brief  : z_btnmgr_ctxCreateMatrixBtn of the default button manager
+ * @param  : see z_btnmgr_ctxCreateMatrixBtn
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_createMatrixBtn(z_btn_t* _btn,z_btnmatrix_t* _matrix,uint8_t _row,uint8_t _col,z_click_event _event)
+{
+    return z_btnmgr_ctxCreateMatrixBtn(base,_btn,_matrix,_row,_col,_event);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_regLadder
+ * @brief  : z_btnmgr_ctxRegLadder of the default button manager
+ * @param  : see z_btnmgr_ctxRegLadder
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_regLadder(z_btnladder_t* _ladder,z_readadc_cb _readadc,const z_btnlevel_t* _levels,
+                           uint8_t _levelnum,uint16_t _hysteresis)
+{
+    return z_btnmgr_ctxRegLadder(base,_ladder,_readadc,_levels,_levelnum,_hysteresis);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_createLadderBtn
+ * @brief  : z_btnmgr_ctxCreateLadderBtn of the default button manager
+ * @param  : see z_btnmgr_ctxCreateLadderBtn
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_createLadderBtn(z_btn_t* _btn,z_btnladder_t* _ladder,uint8_t _bit,z_click_event _event)
+{
+    return z_btnmgr_ctxCreateLadderBtn(base,_btn,_ladder,_bit,_event);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_regShift
+ * @brief  : z_btnmgr_ctxRegShift of the default button manager
+ * @param  : see z_btnmgr_ctxRegShift
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_regShift(z_btnshift_t* _shift,z_btnport_t* _ports,uint8_t* _buf,uint16_t _len,
+                          z_readbytes_cb _readbytes,uint8_t _invert)
+{
+    return z_btnmgr_ctxRegShift(base,_shift,_ports,_buf,_len,_readbytes,_invert);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_createShiftBtn
+ * @brief  : z_btnmgr_ctxCreateShiftBtn of the default button manager
+ * @param  : see z_btnmgr_ctxCreateShiftBtn
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_createShiftBtn(z_btn_t* _btn,z_btnshift_t* _shift,uint16_t _bit,z_click_event _event)
+{
+    return z_btnmgr_ctxCreateShiftBtn(base,_btn,_shift,_bit,_event);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_regGrounp
+ * @brief  : z_btnmgr_ctxRegGrounp of the default button manager
+ * @param  : see z_btnmgr_ctxRegGrounp
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_regGrounp(z_btngroup_t* _group, z_click_event _event)
+{
+    return z_btnmgr_ctxRegGrounp(base,_group,_event);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_regChord
+ * @brief  : z_btnmgr_ctxRegChord of the default button manager
+ * @param  : see z_btnmgr_ctxRegChord
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_regChord(z_btnchord_t* _chord,z_click_event _event)
+{
+    return z_btnmgr_ctxRegChord(base,_chord,_event);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_regSeq
+ * @brief  : z_btnmgr_ctxRegSeq of the default button manager
+ * @param  : see z_btnmgr_ctxRegSeq
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_regSeq(z_btnseq_t* _seq,const z_btnstep_t* _steps,uint8_t _num,z_click_event _event)
+{
+    return z_btnmgr_ctxRegSeq(base,_seq,_steps,_num,_event);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_tick
+ * @brief  : z_btnmgr_ctxTick of the default button manager
+ * @param  : _ms  The recommended time interval for each call is 1-10ms
+ * @return : none
+ */
+void z_btnmgr_tick(uint32_t _ms)
+{
+    z_btnmgr_ctxTick(base,_ms);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_tickTo
+ * @brief  : z_btnmgr_ctxTickTo of the default button manager
+ * @param  : _now  - time of the clock
+ * @return : none
+ */
+void z_btnmgr_tickTo(uint32_t _now)
+{
+    z_btnmgr_ctxTickTo(base,_now);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_dispatch
+ * @brief  : z_btnmgr_ctxDispatch of the default button manager
+ * @param  : _max  - the most events to be handled, 0 is all
+ * @return : res   - number of events that have been handled
+ */
+uint16_t z_btnmgr_dispatch(uint16_t _max)
+{
+    return z_btnmgr_ctxDispatch(base,_max);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_setBatchEvent
+ * @brief  : z_btnmgr_ctxSetBatchEvent of the default button manager
+ * @param  : _batch  - batch callback, 0 goes back to the event callbacks
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_setBatchEvent(z_batch_event _batch)
+{
+    return z_btnmgr_ctxSetBatchEvent(base,_batch);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_getQueueStat
+ * @brief  : z_btnmgr_ctxGetQueueStat of the default button manager
+ * @param  : _stat  - point of statistics
+ * @return : none
+ */
+void z_btnmgr_getQueueStat(z_btnqueue_stat_t* _stat)
+{
+    z_btnmgr_ctxGetQueueStat(base,_stat);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_getStats
+ * @brief  : z_btnmgr_ctxGetStats of the default button manager
+ * @param  : _stats  - point of statistics
+ * @return : none
+ */
+void z_btnmgr_getStats(z_btnstats_t* _stats)
+{
+    z_btnmgr_ctxGetStats(base,_stats);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_clearStats
+ * @brief  : z_btnmgr_ctxClearStats of the default button manager
+ * @param  : none
+ * @return : none
+ */
+void z_btnmgr_clearStats(void)
+{
+    z_btnmgr_ctxClearStats(base);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_nextDeadline
+ * @brief  : z_btnmgr_ctxNextDeadline of the default button manager
+ * @param  : none
+ * @return : res   - time(ticks of the clock) , Z_BTNMGR_DEADLINE_NONE when all are idle
+ */
+uint32_t z_btnmgr_nextDeadline(void)
+{
+    return z_btnmgr_ctxNextDeadline(base);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_getTrace
+ * @brief  : z_btnmgr_ctxGetTrace of the default button manager
+ * @param  : _buf   - buffer of trace
+ *           _size  - size of buffer
+ * @return : res   - bytes of trace
+ */
+uint32_t z_btnmgr_getTrace(uint8_t* _buf,uint32_t _size)
+{
+    return z_btnmgr_ctxGetTrace(base,_buf,_size);
+}
+
+/**-------------------------------------------------------------------
+ * @fn     : z_btnmgr_replay
+ * @brief  : z_btnmgr_ctxReplay of the default button manager
+ * @param  : _trace  - trace data
+ *           _len    - bytes of trace
+ * @return : res  - error status
+ */
+z_err_t z_btnmgr_replay(const uint8_t* _trace,uint32_t _len)
+{
+    return z_btnmgr_ctxReplay(base,_trace,_len);
+}
+
 #endif // __BUTTON_MARGER_ENABLE__
@@ -38,6 +38,211 @@ extern "C"{
 #define Z_BTNMGR_LONGTIME_ACTIVE    1300
 #define Z_BTNMGR_LONGTIME_PEER      100
 #define Z_BTNMGR_DOUBLECLICK_ACTIVE 300
+#define Z_BTNMGR_PRESSING_PERIOD    (Z_BTNMGR_SHORTTIME_ACTIVE + 1)
+
+/* Size of the static button pool, the states of buttons are kept in
+   arrays by button id, 0 keeps them in each button object */
+#ifndef Z_BTNMGR_MAX_BTNS
+#define Z_BTNMGR_MAX_BTNS           0
+#endif
+
+/* Compact pool, 1 : the times of the buttons are 16 bits, and the read
+   callbacks, events, ports and timing profiles are kept once in tables
+   of the manager, each button has their index. The times of the timing
+   profiles must be less than 32768ms, and the tick must be called at
+   least every 32768ms while a button is not idle */
+#ifndef Z_BTNMGR_COMPACT
+#define Z_BTNMGR_COMPACT            0
+#endif
+
+/* Entries of each table of the compact pool (the first is none), up to 255 */
+#ifndef Z_BTNMGR_COMPACT_SHARED
+#define Z_BTNMGR_COMPACT_SHARED     16
+#endif
+#if Z_BTNMGR_COMPACT > 0 && (Z_BTNMGR_MAX_BTNS == 0 || Z_BTNMGR_COMPACT_SHARED > 255)
+#error "Z_BTNMGR_COMPACT needs Z_BTNMGR_MAX_BTNS, and Z_BTNMGR_COMPACT_SHARED must be 255 or less"
+#endif
+
+/* Managers with a compact pool, a button handle has the index of its
+   manager instead of a pointer, up to 255 */
+#ifndef Z_BTNMGR_COMPACT_MGRS
+#define Z_BTNMGR_COMPACT_MGRS       8
+#endif
+#if Z_BTNMGR_COMPACT > 0 && (Z_BTNMGR_COMPACT_MGRS == 0 || Z_BTNMGR_COMPACT_MGRS > 255)
+#error "Z_BTNMGR_COMPACT_MGRS must be 1 to 255"
+#endif
+
+/* Words of the active set of the pool, one bit per button id */
+#define Z_BTNMGR_ACTIVE_WORDS       ((Z_BTNMGR_MAX_BTNS + 31) / 32)
+
+/* Id of the events that do not come from a button of the pool */
+#define Z_BTNMGR_ID_NONE            0xFFFF
+
+/* Bits of the number of slots of the timing wheel of the pool, the wheel
+   has (1 << bits) slots of 1ms and (1 << bits) slots of (1 << bits)ms.
+   A button that only waits for a time leaves the active set until then,
+   0 keeps it in the active set */
+#ifndef Z_BTNMGR_WHEEL_BITS
+#define Z_BTNMGR_WHEEL_BITS         0
+#endif
+#if Z_BTNMGR_WHEEL_BITS > 0
+#if Z_BTNMGR_MAX_BTNS == 0 || Z_BTNMGR_WHEEL_BITS > 6
+#error "Z_BTNMGR_WHEEL_BITS needs Z_BTNMGR_MAX_BTNS, and must be 6 or less"
+#endif
+#define Z_BTNMGR_WHEEL_SLOTS        (1UL << Z_BTNMGR_WHEEL_BITS)
+#endif
+
+/* Ticks of the clock per ms. The tick count, the time of z_btnmgr_tick,
+   z_btnmgr_tickTo, z_btnmgr_pushEdge and of the events are ticks of this
+   clock (e.g. 1000 for a clock of us), the times of the timing profiles
+   stay in ms. The tick count can wrap, a time waited must be less than
+   2^31 ticks of the clock */
+#ifndef Z_BTNMGR_CLOCK_PER_MS
+#define Z_BTNMGR_CLOCK_PER_MS       1
+#endif
+#if Z_BTNMGR_CLOCK_PER_MS > 1 && (Z_BTNMGR_WHEEL_BITS > 0 || Z_BTNMGR_COMPACT > 0)
+#error "Z_BTNMGR_CLOCK_PER_MS must be 1 with Z_BTNMGR_WHEEL_BITS or Z_BTNMGR_COMPACT"
+#endif
+
+/* 1 gives each button its own timing profile by z_btnmgr_setTiming,
+   0 uses the default times for all buttons */
+#ifndef Z_BTNMGR_TIMING_PROFILES
+#define Z_BTNMGR_TIMING_PROFILES    0
+#endif
+
+/* 1 makes the repeat faster by RepeatStep of the timing profile,
+   0 repeats by the fixed period */
+#ifndef Z_BTNMGR_REPEAT_ACCEL
+#define Z_BTNMGR_REPEAT_ACCEL       0
+#endif
+#if Z_BTNMGR_REPEAT_ACCEL > 0 && Z_BTNMGR_TIMING_PROFILES == 0
+#error "Z_BTNMGR_REPEAT_ACCEL needs Z_BTNMGR_TIMING_PROFILES"
+#endif
+
+/* 1 gives the tick count of the debounced edge in the events (EdgeTime),
+   0 compiles it out */
+#ifndef Z_BTNMGR_EDGE_TIME
+#define Z_BTNMGR_EDGE_TIME          0
+#endif
+
+/* 1 adds the eager and integrator debounce of z_btnmgr_setDebounce,
+   0 has only the deferred debounce */
+#ifndef Z_BTNMGR_DEBOUNCE_MODES
+#define Z_BTNMGR_DEBOUNCE_MODES     0
+#endif
+
+/* Number of edges that z_btnmgr_pushEdge can hold between ticks,
+   a power of 2, 0 disables the edge input */
+#ifndef Z_BTNMGR_EDGE_QUEUE_SIZE
+#define Z_BTNMGR_EDGE_QUEUE_SIZE    0
+#endif
+
+/* Number of events that wait for z_btnmgr_dispatch, a power of 2,
+   0 calls the event callback in the tick */
+#ifndef Z_BTNMGR_EVENT_QUEUE_SIZE
+#define Z_BTNMGR_EVENT_QUEUE_SIZE   0
+#endif
+
+/* Events given at once to the batch callback of z_btnmgr_setBatchEvent
+   at the end of a tick (or by z_btnmgr_dispatch with the event queue),
+   0 disables the batch */
+#ifndef Z_BTNMGR_BATCH_SIZE
+#define Z_BTNMGR_BATCH_SIZE         0
+#endif
+
+/* Bytes of the input trace of a manager, the oldest records are
+   dropped when it is full, 0 disables the trace */
+#ifndef Z_BTNMGR_TRACE_SIZE
+#define Z_BTNMGR_TRACE_SIZE         0
+#endif
+
+/* Number of buttons in the trace, by the order of creation */
+#ifndef Z_BTNMGR_TRACE_BTNS
+#if Z_BTNMGR_MAX_BTNS > 0
+#define Z_BTNMGR_TRACE_BTNS         Z_BTNMGR_MAX_BTNS
+#else
+#define Z_BTNMGR_TRACE_BTNS         32
+#endif
+#endif
+#define Z_BTNMGR_TRACE_WORDS        ((Z_BTNMGR_TRACE_BTNS + 31) / 32)
+
+/* Number of buttons that can be keys of chords, by the order of
+   creation (the id in the pool), 0 disables the chords */
+#ifndef Z_BTNMGR_CHORD_BTNS
+#define Z_BTNMGR_CHORD_BTNS         0
+#endif
+#if Z_BTNMGR_CHORD_BTNS > 0
+#define Z_BTNMGR_CHORD_WORDS        ((Z_BTNMGR_CHORD_BTNS + 31) / 32)
+#else
+#define Z_BTNMGR_CHORD_WORDS        1
+#endif
+
+/* Nodes of the automaton of key sequences, shared by all sequences
+   of a manager (1 + the steps that are not a common prefix),
+   0 disables the sequences */
+#ifndef Z_BTNMGR_SEQ_NODES
+#define Z_BTNMGR_SEQ_NODES          0
+#endif
+
+/* Different events (object and state) used by the steps of sequences,
+   a power of 2 */
+#ifndef Z_BTNMGR_SEQ_SYMS
+#define Z_BTNMGR_SEQ_SYMS           16
+#endif
+#if Z_BTNMGR_SEQ_NODES > 255 || Z_BTNMGR_SEQ_SYMS > 64 || (Z_BTNMGR_SEQ_SYMS & (Z_BTNMGR_SEQ_SYMS - 1)) != 0
+#error "Z_BTNMGR_SEQ_NODES must be 255 or less, Z_BTNMGR_SEQ_SYMS a power of 2 up to 64"
+#endif
+
+/* The compact pool keeps no pointer of the button objects, the events
+   give the id only. The key sequences need the pointers */
+#if Z_BTNMGR_COMPACT > 0 && Z_BTNMGR_SEQ_NODES == 0
+#define Z_BTNMGR_POOL_OBJ           0
+#else
+#define Z_BTNMGR_POOL_OBJ           1
+#endif
+
+/* 1 records the statistics of the tick, the events and the edges,
+   Z_BTNMGR_CYCLES() gives a cycle counter (e.g. DWT->CYCCNT).
+   0 compiles it out */
+#ifndef Z_BTNMGR_STATS
+#define Z_BTNMGR_STATS              0
+#endif
+#if Z_BTNMGR_STATS > 0 && !defined(Z_BTNMGR_CYCLES)
+#error "Z_BTNMGR_CYCLES() must read a cycle counter when Z_BTNMGR_STATS is 1"
+#endif
+
+/* Memory barrier between the data and the index of a lock-free queue */
+#ifndef Z_BTNMGR_BARRIER
+#if defined(__GNUC__)
+#define Z_BTNMGR_BARRIER()          __sync_synchronize()
+#else
+#define Z_BTNMGR_BARRIER()
+#endif
+#endif
+
+/* Bit of a state in the event mask of a button */
+#define Z_BTNMGR_EVENT_BIT(_STA_)   (1U << (_STA_))
+#define Z_BTNMGR_EVENT_ALL          0xFFFF
+
+/* Returned by z_btnmgr_nextDeadline when all buttons are idle */
+#define Z_BTNMGR_DEADLINE_NONE      0xFFFFFFFFUL
+
+/* Time in ms between 2 samples of the port debounce, z_btnmgr_nextDeadline
+   returns it while a bit of a port or a ghost key of a matrix is pending,
+   so the 4 samples of a tickless loop are taken over time */
+#ifndef Z_BTNMGR_SAMPLE_MS
+#define Z_BTNMGR_SAMPLE_MS          1
+#endif
+
+/* Initializer of z_btntiming_t with the times above */
+#define Z_BTNMGR_TIMING_DEFAULT     {Z_BTNMGR_SHORTTIME_ACTIVE,Z_BTNMGR_LONGTIME_ACTIVE,\
+                                     Z_BTNMGR_LONGTIME_PEER,Z_BTNMGR_DOUBLECLICK_ACTIVE,0,0,\
+                                     Z_BTNMGR_PRESSING_PERIOD}
+
+/* Bit width of an input port sample, 32 or 64 */
+#ifndef Z_BTNMGR_PORT_WIDTH
+#define Z_BTNMGR_PORT_WIDTH         32
+#endif
 
 #define Z_4BYTESPLITE(_DATA_,_VAL_)   {_DATA_[0]=(_VAL_>>0)&0xFF;_DATA_[1]=(_VAL_>>8)&0xFF;_DATA_[2]=(_VAL_>>16)&0xFF;_DATA_[3]=(_VAL_>>24)&0xFF;}
 #define Z_4BYTECOMBINE(_DATA_,_VAL_)  {_DATA_ =((_VAL_[0]<<0)&0xFF)|((_VAL_[1]<<8)&0xFF00)|((_VAL_[2]<<16)&0xFF0000)|((_VAL_[3]<<24)&0xFF000000);}
@@ -103,6 +308,7 @@ typedef enum {
     BtnSta_DoubleClicked,
     BtnSta_LongPressing,
     BtnSta_LongPressed_Repeat,
+    BtnSta_TripleClicked,
 }z_btn_state_t;
 
 typedef enum {
@@ -114,6 +320,12 @@ typedef enum {
     BtnType_Toggle = 0x20,
 }z_btn_type_t;
 
+typedef enum {
+    BtnDebounce_Deferred = 0x00,   // the level is reported when it was stable for the debounce time
+    BtnDebounce_Eager,             // the first edge is reported at once, then the level is held for the debounce time
+    BtnDebounce_Integrator,        // the time pressed less the time released must reach the debounce time
+}z_btn_debounce_t;
+
 typedef enum {
     BrnGrpProp_None = 0x00,
     BrnGrpProp_Parallel,     /* Functional parallelism
@@ -122,39 +334,425 @@ typedef enum {
                                 When the key group function is triggered, independent keys do not trigger callback events */
 }z_btngrp_property;
 
+typedef enum {
+    ChordMode_All = 0x00,    // all keys of the chord are pressing, the other keys do not matter
+    ChordMode_Exact,         // all keys of the chord are pressing, and no other key
+    ChordMode_Any,           // at least Need keys of the chord are pressing (N of M)
+}z_chord_mode_t;
+
 typedef struct {
-    const void*  Obj;
+    const void*  Obj;        // 0 for a button of the compact pool, see Id
     z_btn_state_t State;
+    uint32_t Time;           // tick count when the event happened
+#if Z_BTNMGR_EDGE_TIME > 0
+    uint32_t EdgeTime;       // tick count of the debounced edge of the button the event comes from,
+                             // the first read of the new level (Time for groups, chords and sequences)
+#endif
+#if Z_BTNMGR_MAX_BTNS > 0
+    uint16_t Id;             // id of the button in the pool, Z_BTNMGR_ID_NONE for the others
+#endif
 }z_btn_args_t;
 
+#if Z_BTNMGR_PORT_WIDTH == 64
+typedef uint64_t z_portval_t;
+#else
+typedef uint32_t z_portval_t;
+#endif
+
 // presing : 1,released : 0
 typedef uint8_t(*z_readbtn_cb)(void);
+// one bit per button, presing : 1,released : 0
+typedef z_portval_t(*z_readport_cb)(void);
+// select one row of matrix to be read, the other rows are released
+typedef void(*z_driverow_cb)(uint8_t _row);
+// one conversion of a ADC input
+typedef uint16_t(*z_readadc_cb)(void);
+// read _len bytes of a chain of shift registers, the first register to _buf[0]
+typedef void(*z_readbytes_cb)(uint8_t* _buf,uint16_t _len);
 typedef void (*z_click_event)(z_btn_args_t _args);
 
+// Input Port Object, sampled once per tick
+typedef struct {
+    z_blist_t List;
+    z_readport_cb ReadPort;
+    z_portval_t Raw;         // last sample
+    z_portval_t Value;       // level of buttons, debounced when Flags.Debounce is set
+    z_portval_t Changed;     // bits of Value that changed in this tick
+    z_portval_t Cnt0;        // vertical counter, bit 0
+    z_portval_t Cnt1;        // vertical counter, bit 1
+#if Z_BTNMGR_MAX_BTNS > 0
+    uint16_t BitBtn[Z_BTNMGR_PORT_WIDTH];  // first button id of each bit, the others by PortNext of the pool,
+                                           // compact pool : the button id, or many buttons of the bit
+#endif
+    struct {
+        uint8_t Debounce : 1;
+    }Flags;
+}z_btnport_t;
+
+// Key Matrix Object, every row is a input port of columns
+typedef struct {
+    z_blist_t List;
+    z_driverow_cb DriveRow;
+    z_readport_cb ReadCols;
+    z_btnport_t* Rows;
+    uint8_t RowNum;
+    uint32_t GhostRows;      // rows ignored in this tick because of ghost keys
+}z_btnmatrix_t;
+
+// One level of a resistor ladder
+typedef struct {
+    uint16_t Value;          // ADC value of the level
+    z_portval_t Btns;        // bits of the buttons pressing at this level, 0 : all released
+}z_btnlevel_t;
+
+// Resistor Ladder Object, many buttons on one ADC input, decoded into a input port
+typedef struct {
+    z_blist_t List;
+    z_readadc_cb ReadAdc;
+    const z_btnlevel_t* Levels;  // sorted by Value, from the lowest
+    uint8_t LevelNum;
+    uint8_t Level;           // level of the last samples
+    uint16_t Hysteresis;     // ADC counts past the middle of two levels to change the level
+    z_btnport_t Port;
+}z_btnladder_t;
+
+/* Ports of a shift register chain of _LEN_ bytes */
+#define Z_BTNMGR_SHIFT_PORTS(_LEN_) (((_LEN_) * 8 + Z_BTNMGR_PORT_WIDTH - 1) / Z_BTNMGR_PORT_WIDTH)
+
+// Shift Register Object, a chain of parallel-in shift registers (74HC165) read in one transfer,
+// bit n of the chain is bit n % Z_BTNMGR_PORT_WIDTH of port n / Z_BTNMGR_PORT_WIDTH
+typedef struct {
+    z_blist_t List;
+    z_readbytes_cb ReadBytes;
+    uint8_t* Buf;            // bytes of the last transfer, Len bytes
+    uint16_t Len;
+    uint8_t Invert;          // a bit is 0 when the button is pressing
+    z_btnport_t* Ports;      // Z_BTNMGR_SHIFT_PORTS(Len) ports
+}z_btnshift_t;
+
+// Timing Profile, shared by the buttons that use it (unit: ms)
+typedef struct {
+    uint16_t Debounce;       // stable time of press and release
+    uint16_t LongPress;      // time of press to be a long press
+    uint16_t Repeat;         // period of repeat in long press, 0 : no repeat
+    uint16_t DoubleClick;    // time to wait the next click
+    uint16_t RepeatStep;     // the period of repeat is shorter by it after each repeat, 0 : no acceleration
+    uint16_t RepeatMin;      // shortest period of repeat
+    uint16_t Pressing;       // period of BtnSta_Pressing while held, 0 : Z_BTNMGR_PRESSING_PERIOD
+}z_btntiming_t;
+
+#if Z_BTNMGR_COMPACT > 0
+// Time of a button in the pool, the low bits of the tick count
+typedef uint16_t z_btntime_t;
+#else
+// Time of a button, the tick count
+typedef uint32_t z_btntime_t;
+#endif
+
+typedef struct {
+    uint8_t NoResp : 1;
+    uint8_t Edge : 1;        // level is given by z_btnmgr_pushEdge
+    uint8_t Level : 1;       // level of a edge button
+    uint8_t Reg : 1;         // handled by the tick, in the pool
+    uint8_t StartPresseTimeSet : 1;   // StartPresseTime is a time, 0 : no press is seen
+    uint8_t StartReleaseTimeSet : 1;  // StartReleaseTime is a time, 0 : no release is seen
+    uint8_t Pressed : 1;     // a press ended, not read by z_btnmgr_wasPressed yet
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+    uint8_t Filter : 1;      // level given by the eager or integrator debounce
+    uint8_t Hold : 1;        // eager : the level is held after a edge, integrator : level of the last read
+#endif
+}z_btnflags_t;
+
+// Button Manager Object
+typedef struct z_btnmgr_ctx z_btnmgr_ctx_t;
+
+#if Z_BTNMGR_MAX_BTNS > 0
+// One Button Object, a handle of the button in the pool
+typedef struct {
+  uint16_t Id;
+#if Z_BTNMGR_COMPACT > 0
+  uint8_t Mgr;               // index of the manager, 0 : not created
+#else
+  z_btnmgr_ctx_t* Ctx;
+#endif
+}z_btn_t;
+#else
 // One Button Object
 typedef struct {
   z_readbtn_cb ClickAction;
   z_click_event Event;
+  z_btnport_t* Port;
+#if Z_BTNMGR_TIMING_PROFILES > 0
+  const z_btntiming_t* Timing;
+#endif
+  uint8_t PortBit;
+  uint8_t Type;              // z_btn_type_t, kind of clicks reported
+  uint8_t Clicks;            // clicks in the double click time
+  uint8_t State;             // z_btn_state_t
+  z_btnflags_t Flags;
+  uint16_t EventMask;        // states that call the event, Z_BTNMGR_EVENT_BIT
   uint32_t StartPresseTime;
-  uint32_t PressTimeBuf;
-  uint32_t StartReleaseTime;
-  z_btn_state_t State;
-  z_btn_state_t PreState;
+  uint32_t PressTimeBuf;     // pressing : last pressing event , long pressing : next repeat
+  uint32_t StartReleaseTime; // releasing : time of the last click
+#if Z_BTNMGR_EDGE_TIME > 0
+  uint32_t EdgeTime;         // time of the last debounced edge
+#endif
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+  uint32_t FilterTime;       // eager : time of the last edge, integrator : time of the last read
+  uint32_t FilterSum;        // integrator : time pressed less time released, 0 to the debounce time
+  uint8_t DebounceMode;      // z_btn_debounce_t
+#endif
+#if Z_BTNMGR_REPEAT_ACCEL > 0
+  uint16_t RepeatPeriod;     // long pressing : period of the next repeat
+#endif
+#if Z_BTNMGR_STATS > 0
+  uint16_t LatencyMax;       // most time from the first pressed read to BtnSta_Pressing
+#endif
   z_blist_t List;
-  struct {
-      uint8_t NoResp : 1;
-  }Flags;
+  z_btnmgr_ctx_t* Ctx;
+#if Z_BTNMGR_TRACE_SIZE > 0 || Z_BTNMGR_CHORD_BTNS > 0
+  uint16_t Id;               // order of creation, the id in the trace and the chords
+#endif
 }z_btn_t;
+#endif
 
 // Button Group Object
 typedef struct {
     z_blist_t List;
+#if Z_BTNMGR_COMPACT > 0
+    z_btnmgr_ctx_t* Ctx;
+    uint32_t Btns[Z_BTNMGR_ACTIVE_WORDS];    // one bit per button id
+#elif Z_BTNMGR_MAX_BTNS > 0
+    z_btnmgr_ctx_t* Ctx;
+    uint16_t BtnsHead;       // first button id, the others by GroupNext of the pool
+#else
     z_blist_t BtnsList;
+#endif
     z_click_event Event;
     z_btn_state_t State;
     z_btngrp_property Property;
 }z_btngroup_t;
 
+// Chord Object, a set of keys by button id, a button can be a key of many chords
+typedef struct {
+    z_blist_t List;
+    uint32_t Keys[Z_BTNMGR_CHORD_WORDS];
+    z_click_event Event;
+    z_btnmgr_ctx_t* Ctx;
+    z_btn_state_t State;
+    z_btngrp_property Property;
+    uint8_t Mode;            // z_chord_mode_t
+    uint8_t Need;            // ChordMode_Any : keys that must be pressing
+}z_btnchord_t;
+
+// One step of a key sequence, a event of a button, a group or a chord
+typedef struct {
+    const void* Obj;
+    z_btn_state_t State;
+    uint16_t Window;         // most time(ms) from the step before, 0 : no limit
+}z_btnstep_t;
+
+// Key Sequence Object, the steps are kept by pointer
+typedef struct {
+    z_blist_t List;
+    const z_btnstep_t* Steps;
+    z_click_event Event;
+    uint8_t Num;
+}z_btnseq_t;
+
+#if Z_BTNMGR_MAX_BTNS > 0
+// Static button pool, the fields of button id n are the member n of arrays
+typedef struct {
+#if Z_BTNMGR_POOL_OBJ > 0
+    z_btn_t* Obj[Z_BTNMGR_MAX_BTNS];
+#endif
+#if Z_BTNMGR_COMPACT > 0
+    uint8_t ClickAction[Z_BTNMGR_MAX_BTNS];  // index in the tables of the manager, 0 : none
+    uint8_t Event[Z_BTNMGR_MAX_BTNS];
+    uint8_t Port[Z_BTNMGR_MAX_BTNS];
+#if Z_BTNMGR_TIMING_PROFILES > 0
+    uint8_t Timing[Z_BTNMGR_MAX_BTNS];
+#endif
+#else
+    z_readbtn_cb ClickAction[Z_BTNMGR_MAX_BTNS];
+    z_click_event Event[Z_BTNMGR_MAX_BTNS];
+    z_btnport_t* Port[Z_BTNMGR_MAX_BTNS];
+#if Z_BTNMGR_TIMING_PROFILES > 0
+    const z_btntiming_t* Timing[Z_BTNMGR_MAX_BTNS];
+#endif
+#endif
+    z_btntime_t StartPresseTime[Z_BTNMGR_MAX_BTNS];
+    z_btntime_t PressTimeBuf[Z_BTNMGR_MAX_BTNS];
+    z_btntime_t StartReleaseTime[Z_BTNMGR_MAX_BTNS];
+#if Z_BTNMGR_EDGE_TIME > 0
+    z_btntime_t EdgeTime[Z_BTNMGR_MAX_BTNS]; // time of the last debounced edge, compact pool : in 65535ms before now
+#endif
+#if Z_BTNMGR_DEBOUNCE_MODES > 0
+    z_btntime_t FilterTime[Z_BTNMGR_MAX_BTNS];
+    z_btntime_t FilterSum[Z_BTNMGR_MAX_BTNS];
+    uint8_t DebounceMode[Z_BTNMGR_MAX_BTNS];
+#endif
+    uint8_t PortBit[Z_BTNMGR_MAX_BTNS];
+#if Z_BTNMGR_COMPACT == 0
+    uint16_t PortNext[Z_BTNMGR_MAX_BTNS];    // next button of the same port bit
+    uint16_t GroupNext[Z_BTNMGR_MAX_BTNS];   // next button of the same group
+#endif
+    uint8_t Type[Z_BTNMGR_MAX_BTNS];
+    uint8_t Clicks[Z_BTNMGR_MAX_BTNS];
+    uint16_t EventMask[Z_BTNMGR_MAX_BTNS];
+#if Z_BTNMGR_REPEAT_ACCEL > 0
+    uint16_t RepeatPeriod[Z_BTNMGR_MAX_BTNS];
+#endif
+    uint8_t State[Z_BTNMGR_MAX_BTNS];
+#if Z_BTNMGR_STATS > 0
+    uint16_t LatencyMax[Z_BTNMGR_MAX_BTNS];
+#endif
+    z_btnflags_t Flags[Z_BTNMGR_MAX_BTNS];
+    uint32_t Active[Z_BTNMGR_ACTIVE_WORDS];  // buttons that the tick handles
+#if Z_BTNMGR_WHEEL_BITS > 0
+    z_btntime_t WheelTime[Z_BTNMGR_MAX_BTNS];  // tick count the button waits for in the wheel
+    uint16_t WheelNext[Z_BTNMGR_MAX_BTNS];   // buttons in the same slot
+    uint16_t WheelPrev[Z_BTNMGR_MAX_BTNS];
+    uint8_t WheelSlot[Z_BTNMGR_MAX_BTNS];    // slot of the button, 0xFF when it is not in the wheel
+#endif
+    uint16_t Count;
+}z_btnpool_t;
+#endif
+
+// A level change of a edge button
+typedef struct {
+    z_btn_t* Btn;
+    uint32_t Time;
+    uint8_t Level;
+}z_btnedge_t;
+
+// A event waiting for z_btnmgr_dispatch
+typedef struct {
+    const void* Obj;
+    z_click_event Event;
+    uint32_t Time;
+#if Z_BTNMGR_EDGE_TIME > 0
+    uint32_t EdgeTime;       // as z_btn_args_t
+#endif
+#if Z_BTNMGR_MAX_BTNS > 0
+    uint16_t Id;             // as z_btn_args_t
+#endif
+    uint8_t State;
+}z_btnevent_t;
+
+// all events of a tick, in order, _end is true in the last call of the tick
+typedef void (*z_batch_event)(const z_btnevent_t* _events,uint16_t _num,uint8_t _end);
+
+// Statistics of the hot path, a histogram has one bin per power of 2 :
+// bin n counts the values from 2^n to 2^(n+1)-1 , bin 0 counts 0 and 1
+typedef struct {
+    uint32_t Ticks;
+    uint32_t TickHist[32];   // ticks by cycles of z_btnmgr_tick
+    uint32_t TickMax;        // cycles
+    uint32_t Events;         // events of all ticks
+    uint32_t EventsMax;      // most events in one tick
+    uint32_t LatencyHist[16];// BtnSta_Pressing by ticks of the clock from the first pressed read
+    uint32_t LatencyMax;     // ticks of the clock
+    uint32_t EdgeMax;        // most cycles of z_btnmgr_pushEdge, in the interrupt
+}z_btnstats_t;
+
+// Button Manager Object, all states of one manager, used by z_btnmgr.c only.
+// Managers share nothing, each one can run in its own task or core.
+struct z_btnmgr_ctx {
+    z_blist_t Btns_BListHead;      // The list head of a button
+    z_blist_t BtnGrounp_BListHead; // The list head of a button group collection
+    z_blist_t Ports_BListHead;     // The list head of a input port collection
+    z_blist_t Matrix_BListHead;    // The list head of a key matrix collection
+    z_blist_t Ladder_BListHead;    // The list head of a resistor ladder collection
+    z_blist_t Shift_BListHead;     // The list head of a shift register collection
+    uint32_t TickCount;
+#if Z_BTNMGR_MAX_BTNS > 0
+    z_btnpool_t Pool;
+    uint8_t PortBtnsChanged;       // the buttons of the port bits are found again in the next tick
+#if Z_BTNMGR_WHEEL_BITS > 0
+    uint16_t Wheel[Z_BTNMGR_WHEEL_SLOTS * 2];  // first button of the slots of 1ms, then of (1 << bits)ms
+    uint32_t WheelBits[(Z_BTNMGR_WHEEL_SLOTS * 2 + 31) / 32];  // the slots that have a button
+    uint32_t WheelNow;             // tick count the wheel has run to
+    uint16_t WheelNum;             // buttons in the wheel
+#endif
+#if Z_BTNMGR_COMPACT > 0
+    z_readbtn_cb SharedRead[Z_BTNMGR_COMPACT_SHARED];         // tables of the compact pool
+    z_click_event SharedEvent[Z_BTNMGR_COMPACT_SHARED];
+    z_btnport_t* SharedPort[Z_BTNMGR_COMPACT_SHARED];
+#if Z_BTNMGR_TIMING_PROFILES > 0
+    const z_btntiming_t* SharedTiming[Z_BTNMGR_COMPACT_SHARED];
+#endif
+    uint8_t Mgr;                   // index of the manager in the button handles, 0 : none is free
+#endif
+#endif
+#if Z_BTNMGR_EDGE_QUEUE_SIZE > 0
+    z_btnedge_t EdgeQueue[Z_BTNMGR_EDGE_QUEUE_SIZE];
+    volatile uint16_t EdgeHead;    // written by z_btnmgr_pushEdge only
+    volatile uint16_t EdgeTail;    // written by z_btnmgr_tick only
+    volatile uint32_t EdgeLost;    // edges dropped because the queue was full
+#endif
+#if Z_BTNMGR_EVENT_QUEUE_SIZE > 0
+    z_btnevent_t EventQueue[Z_BTNMGR_EVENT_QUEUE_SIZE];
+    volatile uint16_t EventHead;   // written by z_btnmgr_tick only
+    volatile uint16_t EventTail;   // written by z_btnmgr_dispatch only
+    uint32_t EventLost;            // events dropped because the queue was full
+    uint16_t EventPeak;            // the most events that were waiting at once
+#endif
+#if Z_BTNMGR_BATCH_SIZE > 0
+    z_batch_event BatchEvent;
+#if Z_BTNMGR_EVENT_QUEUE_SIZE == 0
+    z_btnevent_t Batch[Z_BTNMGR_BATCH_SIZE];      // events of this tick
+    uint16_t BatchNum;
+#endif
+#endif
+#if Z_BTNMGR_MAX_BTNS == 0 && (Z_BTNMGR_TRACE_SIZE > 0 || Z_BTNMGR_CHORD_BTNS > 0)
+    uint16_t BtnIds;               // next id of button
+#endif
+#if Z_BTNMGR_CHORD_BTNS > 0
+    z_blist_t Chord_BListHead;     // The list head of a chord collection
+    uint32_t ChordPressed[Z_BTNMGR_CHORD_WORDS];  // keys pressing
+    uint32_t ChordMutex[Z_BTNMGR_CHORD_WORDS];    // keys of mutex chords that are pressing, no event
+    uint8_t ChordChanged;          // a key changed in this tick
+#endif
+#if Z_BTNMGR_SEQ_NODES > 0
+    z_blist_t Seq_BListHead;       // The list head of a key sequence collection
+    const void* SeqSymObj[Z_BTNMGR_SEQ_SYMS];     // events of the steps
+    uint8_t SeqSymState[Z_BTNMGR_SEQ_SYMS];
+    uint8_t SeqSymHash[Z_BTNMGR_SEQ_SYMS * 2];    // symbol + 1 by hash of the event
+    uint8_t SeqNext[Z_BTNMGR_SEQ_NODES][Z_BTNMGR_SEQ_SYMS];  // transitions of the automaton
+    uint16_t SeqWindow[Z_BTNMGR_SEQ_NODES];       // most time(ms) to enter a node
+    z_btnseq_t* SeqOut[Z_BTNMGR_SEQ_NODES];       // sequence recognized at a node
+    uint8_t SeqSymNum;
+    uint8_t SeqNodeNum;
+    uint8_t SeqNode;               // node of the automaton
+    uint32_t SeqTime;              // time of the last step
+#endif
+#if Z_BTNMGR_STATS > 0
+    z_btnstats_t Stats;
+    uint32_t StatsEvents;          // events in this tick
+#endif
+#if Z_BTNMGR_TRACE_SIZE > 0
+    uint8_t TraceBuf[Z_BTNMGR_TRACE_SIZE];          // ring of records
+    uint32_t TraceHead;
+    uint32_t TraceTail;
+    uint32_t TraceUsed;
+    uint32_t TraceBaseTick;                          // tick count before the oldest record
+    uint32_t TraceBaseLevel[Z_BTNMGR_TRACE_WORDS];   // levels before the oldest record
+    uint32_t TraceLevel[Z_BTNMGR_TRACE_WORDS];       // levels of the last reads
+    uint32_t TraceChanged[Z_BTNMGR_TRACE_WORDS];     // levels changed in this tick
+    uint32_t TraceIdleNum;                           // ticks without change, not written yet
+    uint32_t TraceIdleMs;
+    uint8_t TraceReplay;                             // levels are given by z_btnmgr_replay
+#endif
+};
+
+
+// Statistics of the edge and event queues
+typedef struct {
+    uint32_t EdgeLost;       // edges dropped because the edge queue was full
+    uint32_t EventLost;      // events dropped because the event queue was full
+    uint16_t EventPeak;      // the most events that were waiting at once
+}z_btnqueue_stat_t;
 
 typedef uint32_t z_err_t;
 // VLAUE ---------------------------------------------------------------------
@@ -164,16 +762,83 @@ typedef uint32_t z_err_t;
 void z_btnmgr_init(void);
 z_err_t z_btnmgr_creategBtn(z_btn_t* _btn,z_readbtn_cb _readbtn, z_click_event _event);
 z_err_t z_btnmgr_regBtn(z_btn_t* _btn);
+z_err_t z_btnmgr_regPort(z_btnport_t* _port,z_readport_cb _readport);
+z_err_t z_btnmgr_setPortDebounce(z_btnport_t* _port,uint8_t _enable);
+z_err_t z_btnmgr_createPortBtn(z_btn_t* _btn,z_btnport_t* _port,uint8_t _bit,z_click_event _event);
+z_err_t z_btnmgr_createEdgeBtn(z_btn_t* _btn,uint8_t _level,z_click_event _event);
+z_err_t z_btnmgr_pushEdge(z_btn_t* _btn,uint8_t _level,uint32_t _time);
+uint32_t z_btnmgr_getTickCount(void);
+z_err_t z_btnmgr_regMatrix(z_btnmatrix_t* _matrix,z_btnport_t* _rows,uint8_t _rownum,
+                           z_driverow_cb _driverow,z_readport_cb _readcols);
+z_err_t z_btnmgr_setMatrixDebounce(z_btnmatrix_t* _matrix,uint8_t _enable);
+z_err_t z_btnmgr_createMatrixBtn(z_btn_t* _btn,z_btnmatrix_t* _matrix,uint8_t _row,uint8_t _col,z_click_event _event);
+z_err_t z_btnmgr_regLadder(z_btnladder_t* _ladder,z_readadc_cb _readadc,const z_btnlevel_t* _levels,
+                           uint8_t _levelnum,uint16_t _hysteresis);
+z_err_t z_btnmgr_createLadderBtn(z_btn_t* _btn,z_btnladder_t* _ladder,uint8_t _bit,z_click_event _event);
+z_err_t z_btnmgr_regShift(z_btnshift_t* _shift,z_btnport_t* _ports,uint8_t* _buf,uint16_t _len,
+                          z_readbytes_cb _readbytes,uint8_t _invert);
+z_err_t z_btnmgr_setShiftDebounce(z_btnshift_t* _shift,uint8_t _enable);
+z_err_t z_btnmgr_createShiftBtn(z_btn_t* _btn,z_btnshift_t* _shift,uint16_t _bit,z_click_event _event);
 z_err_t z_btnmgr_regGrounp(z_btngroup_t *_group,z_click_event _event);
 z_err_t z_btnmgr_setGrounp(z_btngroup_t *_group,z_btn_t* _btn);
 z_err_t z_btnmgr_setGrpProperty(z_btngroup_t *_group,z_btngrp_property _val);
+z_err_t z_btnmgr_regChord(z_btnchord_t *_chord,z_click_event _event);
+z_err_t z_btnmgr_setChordKey(z_btnchord_t *_chord,z_btn_t* _btn);
+z_err_t z_btnmgr_setChordMode(z_btnchord_t *_chord,z_chord_mode_t _mode,uint8_t _need);
+z_err_t z_btnmgr_setChordProperty(z_btnchord_t *_chord,z_btngrp_property _val);
+z_err_t z_btnmgr_regSeq(z_btnseq_t *_seq,const z_btnstep_t* _steps,uint8_t _num,z_click_event _event);
 z_err_t z_btnmgr_setType(z_btn_t* _btn,z_btn_type_t _prop);
+z_err_t z_btnmgr_setTiming(z_btn_t* _btn,const z_btntiming_t* _timing);
+z_err_t z_btnmgr_setEventMask(z_btn_t* _btn,uint16_t _mask);
+z_err_t z_btnmgr_setDebounce(z_btn_t* _btn,z_btn_debounce_t _mode);
 
 uint8_t z_btnmgr_isPressing(z_btn_t* _btn);
 uint8_t z_btnmgr_wasPressed(z_btn_t *_btn);
 uint8_t z_btnmgr_isReleasing(z_btn_t* _btn);
+uint32_t z_btnmgr_getLatency(z_btn_t* _btn);
 
 void z_btnmgr_tick(uint32_t _ms);
+void z_btnmgr_tickTo(uint32_t _now);
+uint16_t z_btnmgr_dispatch(uint16_t _max);
+z_err_t z_btnmgr_setBatchEvent(z_batch_event _batch);
+void z_btnmgr_getQueueStat(z_btnqueue_stat_t* _stat);
+void z_btnmgr_getStats(z_btnstats_t* _stats);
+void z_btnmgr_clearStats(void);
+uint32_t z_btnmgr_nextDeadline(void);
+uint32_t z_btnmgr_getTrace(uint8_t* _buf,uint32_t _size);
+z_err_t z_btnmgr_replay(const uint8_t* _trace,uint32_t _len);
+
+// the functions of a button manager, the functions above use the default one
+void z_btnmgr_ctxInit(z_btnmgr_ctx_t* _ctx);
+z_err_t z_btnmgr_ctxCreategBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_readbtn_cb _readbtn, z_click_event _event);
+z_err_t z_btnmgr_ctxRegPort(z_btnmgr_ctx_t* _ctx,z_btnport_t* _port,z_readport_cb _readport);
+z_err_t z_btnmgr_ctxCreatePortBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_btnport_t* _port,uint8_t _bit,z_click_event _event);
+z_err_t z_btnmgr_ctxCreateEdgeBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,uint8_t _level,z_click_event _event);
+uint32_t z_btnmgr_ctxGetTickCount(z_btnmgr_ctx_t* _ctx);
+z_err_t z_btnmgr_ctxRegMatrix(z_btnmgr_ctx_t* _ctx,z_btnmatrix_t* _matrix,z_btnport_t* _rows,uint8_t _rownum,
+                              z_driverow_cb _driverow,z_readport_cb _readcols);
+z_err_t z_btnmgr_ctxCreateMatrixBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_btnmatrix_t* _matrix,uint8_t _row,uint8_t _col,z_click_event _event);
+z_err_t z_btnmgr_ctxRegLadder(z_btnmgr_ctx_t* _ctx,z_btnladder_t* _ladder,z_readadc_cb _readadc,
+                              const z_btnlevel_t* _levels,uint8_t _levelnum,uint16_t _hysteresis);
+z_err_t z_btnmgr_ctxCreateLadderBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_btnladder_t* _ladder,uint8_t _bit,z_click_event _event);
+z_err_t z_btnmgr_ctxRegShift(z_btnmgr_ctx_t* _ctx,z_btnshift_t* _shift,z_btnport_t* _ports,uint8_t* _buf,uint16_t _len,
+                             z_readbytes_cb _readbytes,uint8_t _invert);
+z_err_t z_btnmgr_ctxCreateShiftBtn(z_btnmgr_ctx_t* _ctx,z_btn_t* _btn,z_btnshift_t* _shift,uint16_t _bit,z_click_event _event);
+z_err_t z_btnmgr_ctxRegGrounp(z_btnmgr_ctx_t* _ctx,z_btngroup_t *_group,z_click_event _event);
+z_err_t z_btnmgr_ctxRegChord(z_btnmgr_ctx_t* _ctx,z_btnchord_t *_chord,z_click_event _event);
+z_err_t z_btnmgr_ctxRegSeq(z_btnmgr_ctx_t* _ctx,z_btnseq_t *_seq,const z_btnstep_t* _steps,uint8_t _num,
+                           z_click_event _event);
+
+void z_btnmgr_ctxTick(z_btnmgr_ctx_t* _ctx,uint32_t _ms);
+void z_btnmgr_ctxTickTo(z_btnmgr_ctx_t* _ctx,uint32_t _now);
+uint16_t z_btnmgr_ctxDispatch(z_btnmgr_ctx_t* _ctx,uint16_t _max);
+z_err_t z_btnmgr_ctxSetBatchEvent(z_btnmgr_ctx_t* _ctx,z_batch_event _batch);
+void z_btnmgr_ctxGetQueueStat(z_btnmgr_ctx_t* _ctx,z_btnqueue_stat_t* _stat);
+void z_btnmgr_ctxGetStats(z_btnmgr_ctx_t* _ctx,z_btnstats_t* _stats);
+void z_btnmgr_ctxClearStats(z_btnmgr_ctx_t* _ctx);
+uint32_t z_btnmgr_ctxNextDeadline(z_btnmgr_ctx_t* _ctx);
+uint32_t z_btnmgr_ctxGetTrace(z_btnmgr_ctx_t* _ctx,uint8_t* _buf,uint32_t _size);
+z_err_t z_btnmgr_ctxReplay(z_btnmgr_ctx_t* _ctx,const uint8_t* _trace,uint32_t _len);
 
 #ifdef __cplusplus
 }
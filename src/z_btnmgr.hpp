@@ -0,0 +1,391 @@
+/*--------------------------------------------------------------------
+@file            : z_btnmgr.hpp
+@brief           : C++ front-end of the button manager.
+                   The reader, event, type and times of every button are
+                   template parameters, so the tick of a ButtonManager is
+                   compiled to inline code of the buttons in use, without
+                   function pointers, lists or the features not used.
+----------------------------------------------------------------------
+ File Version    : V1.00 , first release of the C++11 front-end
+ Requires        : z_btnmgr.h V1.01 , a C++11 compiler
+----------------------------------------------------------------------
+@attention       :
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    Header only, C++11. The states and events are the same as the C API
+    (z_btnmgr.c is not needed), the button groups, input ports, edge input
+    and event queue are not supported here.
+--------------------------------------------------------------------*/
+#ifndef __z_BTNMGR_HPP__
+#define __z_BTNMGR_HPP__
+
+#include "z_btnmgr.h"
+
+namespace z_btnmgr {
+
+// TYPE ----------------------------------------------------------------------
+
+// Timing Profile of a button at compile time (unit: ms), Repeat 0 : no repeat,
+// RepeatStep 0 : the period of repeat is fixed, Pressing 0 : the period of
+// BtnSta_Pressing is Z_BTNMGR_PRESSING_PERIOD. The members are in ticks of
+// the clock (Z_BTNMGR_CLOCK_PER_MS)
+template <uint16_t _Debounce = Z_BTNMGR_SHORTTIME_ACTIVE,
+          uint16_t _LongPress = Z_BTNMGR_LONGTIME_ACTIVE,
+          uint16_t _Repeat = Z_BTNMGR_LONGTIME_PEER,
+          uint16_t _DoubleClick = Z_BTNMGR_DOUBLECLICK_ACTIVE,
+          uint16_t _RepeatStep = 0,
+          uint16_t _RepeatMin = 0,
+          uint16_t _Pressing = 0>
+struct Timing {
+    static constexpr uint32_t Debounce = (uint32_t)_Debounce * Z_BTNMGR_CLOCK_PER_MS;
+    static constexpr uint32_t LongPress = (uint32_t)_LongPress * Z_BTNMGR_CLOCK_PER_MS;
+    static constexpr uint32_t Repeat = (uint32_t)_Repeat * Z_BTNMGR_CLOCK_PER_MS;
+    static constexpr uint32_t DoubleClick = (uint32_t)_DoubleClick * Z_BTNMGR_CLOCK_PER_MS;
+    static constexpr uint32_t RepeatStep = (uint32_t)_RepeatStep * Z_BTNMGR_CLOCK_PER_MS;
+    static constexpr uint32_t RepeatMin = (uint32_t)(_RepeatMin != 0 ? _RepeatMin : 1) * Z_BTNMGR_CLOCK_PER_MS;
+    static constexpr uint32_t Pressing = (uint32_t)(_Pressing != 0 ? _Pressing : Z_BTNMGR_PRESSING_PERIOD) * Z_BTNMGR_CLOCK_PER_MS;
+};
+
+/**-------------------------------------------------------------------
+ * @class  : Button
+ * @brief  : One button, the same state machine as z_btnmgr_btnProc.
+ * @param  : _Read    - read the level of button, presing : 1,released : 0
+ *           _Event   - event callback, nullptr for no event
+ *           _Type    - kind of clicks reported (z_btn_type_t)
+ *           _Timing  - times of button, a Timing<...>
+ *           _Debounce - debounce of the level (z_btn_debounce_t)
+ */
+template <z_readbtn_cb _Read,
+          z_click_event _Event = nullptr,
+          z_btn_type_t _Type = BtnType_SingleClicked,
+          class _Timing = Timing<>,
+          z_btn_debounce_t _Debounce = BtnDebounce_Deferred>
+class Button {
+public:
+    typedef _Timing TimingType;
+    static constexpr bool HasEvent = _Event != nullptr;
+    static constexpr bool HasRepeat = _Timing::Repeat != 0;
+    static constexpr bool HasClicks = _Type == BtnType_DoubleClicked || _Type == BtnType_BothClicked;
+    // the eager and integrator filters debounce the level, the state machine does not
+    static constexpr uint32_t DebounceTime = _Debounce == BtnDebounce_Deferred ? _Timing::Debounce : 0;
+
+    bool isPressing(void) const {
+        return State == BtnSta_Pressing || State == BtnSta_LongPressing;
+    }
+    bool wasPressed(void) {
+        bool res = PreState == BtnSta_Pressed;
+        if (res) {
+            PreState = BtnSta_None;
+        }
+        return res;
+    }
+    bool isReleasing(void) const {
+        return State == BtnSta_Releasing;
+    }
+    z_btn_state_t state(void) const {
+        return State;
+    }
+
+    /**-------------------------------------------------------------------
+     * @fn     : proc
+     * @brief  : Button handling function
+     * @param  : _tick  - tick count of this tick
+     * @return : none
+     */
+    inline void proc(uint32_t _tick) {
+        switch (State) {
+        case BtnSta_Releasing: State = releasingProc(_tick,filterLevel(_tick,_Read())); break;
+        case BtnSta_Pressing: State = pressingProc(_tick,filterLevel(_tick,_Read())); break;
+        case BtnSta_LongPressing: State = longPressingProc(_tick,filterLevel(_tick,_Read())); break;
+        case BtnSta_Clicked:
+        case BtnSta_Pressed: State = pressedOrClickedProc(_tick); break;
+        default: State = BtnSta_Releasing; break;
+        }
+    }
+
+private:
+    uint32_t StartPresseTime = 0;
+    uint32_t PressTimeBuf = 0;       // pressing : last pressing event , long pressing : next repeat
+    uint32_t StartReleaseTime = 0;   // releasing : time of the last click
+    uint32_t EdgeTime = 0;           // time of the last debounced edge
+    uint32_t RepeatPeriod = 0;       // long pressing : time to the next repeat
+    z_btn_state_t State = BtnSta_Releasing;
+    z_btn_state_t PreState = BtnSta_None;
+    uint8_t Clicks = 0;              // clicks in the double click time
+    bool PressSet = false;           // StartPresseTime is a time
+    bool ReleaseSet = false;         // StartReleaseTime is a time
+    uint32_t FilterTime = 0;         // eager : time of the last edge, integrator : time of the last read
+    uint32_t FilterSum = 0;          // integrator : time pressed less time released
+    uint8_t Filter = 0;              // level given by the eager or integrator debounce
+    uint8_t Hold = 0;                // eager : the level is held after a edge, integrator : level of the last read
+
+    // time from a tick count to _tick, right also when the tick count wraps
+    static inline uint32_t since(uint32_t _tick,uint32_t _time) {
+        return _tick - _time;
+    }
+
+    inline void callEvent(uint32_t _tick,z_btn_state_t _sta) const {
+        if (HasEvent) {
+            z_btn_args_t args;
+            args.Obj = this;
+            args.State = _sta;
+            args.Time = _tick;
+#if Z_BTNMGR_EDGE_TIME > 0
+            args.EdgeTime = EdgeTime;
+#endif
+#if Z_BTNMGR_MAX_BTNS > 0
+            args.Id = Z_BTNMGR_ID_NONE;
+#endif
+            _Event(args);
+        }
+    }
+
+    // Debounce the level of a eager or integrator button
+    inline uint8_t filterLevel(uint32_t _tick,uint8_t _level) {
+        if (_Debounce == BtnDebounce_Eager) {
+            if (Hold == 1 && since(_tick,FilterTime) >= _Timing::Debounce) {
+                Hold = 0;
+            }
+            // a edge is reported at once, the bounces after it are not seen
+            if (Hold == 0 && Filter != _level) {
+                Filter = _level;
+                Hold = 1;
+                FilterTime = _tick;
+            }
+            return Filter;
+        }
+        if (_Debounce == BtnDebounce_Integrator) {
+            // the level of the last read is held until this read
+            uint32_t time = since(_tick,FilterTime);
+            if (Hold == 1) {
+                FilterSum = time < _Timing::Debounce - FilterSum ? FilterSum + time : _Timing::Debounce;
+                Filter = FilterSum == _Timing::Debounce ? 1 : Filter;
+            }
+            else {
+                FilterSum = time < FilterSum ? FilterSum - time : 0;
+                Filter = FilterSum == 0 ? 0 : Filter;
+            }
+            FilterTime = _tick;
+            Hold = _level;
+            return Filter;
+        }
+        return _level;
+    }
+
+    // Count a click, and returns the event of it, BtnSta_None when it waits the next click
+    inline z_btn_state_t clickEvent(void) {
+        z_btn_state_t res = BtnSta_Clicked;
+        if (_Type == BtnType_DoubleClicked) {
+            Clicks = Clicks == 0 ? 1 : 0;
+            res = Clicks == 0 ? BtnSta_DoubleClicked : BtnSta_None;
+        }
+        else if (_Type == BtnType_BothClicked) {
+            Clicks++;
+            if (Clicks == 2) {
+                res = BtnSta_DoubleClicked;
+            }
+            else if (Clicks >= 3) {
+                Clicks = 0;
+                res = BtnSta_TripleClicked;
+            }
+        }
+        return res;
+    }
+
+    // The clicks end, report the click that is waiting
+    inline void clickTimeout(uint32_t _tick) {
+        if (_Type == BtnType_DoubleClicked) {
+            callEvent(_tick,BtnSta_Clicked);
+        }
+        Clicks = 0;
+    }
+
+    inline z_btn_state_t releasingProc(uint32_t _tick,uint8_t _level) {
+        // no next click in the double click time
+        if (HasClicks && Clicks != 0 && !PressSet &&
+            since(_tick,StartReleaseTime) >= _Timing::DoubleClick) {
+            clickTimeout(_tick);
+        }
+        if (_level == 0) {
+            PressSet = false;
+            return BtnSta_Releasing;
+        }
+        if (!PressSet) {
+            StartPresseTime = _tick;
+            PressSet = true;
+        }
+        if (since(_tick,StartPresseTime) + 1 < DebounceTime) {
+            return BtnSta_Releasing;
+        }
+        ReleaseSet = false;
+        PressTimeBuf = _tick;
+        EdgeTime = StartPresseTime;
+        callEvent(_tick,BtnSta_Pressing);
+        return BtnSta_Pressing;
+    }
+
+    inline z_btn_state_t pressingProc(uint32_t _tick,uint8_t _level) {
+        // Button release detected
+        if (_level == 0) {
+            if (!ReleaseSet) {
+                StartReleaseTime = _tick;
+                ReleaseSet = true;
+            }
+            if (since(_tick,StartReleaseTime) >= DebounceTime) {
+                z_btn_state_t sta = HasClicks ? clickEvent() : BtnSta_Clicked;
+                EdgeTime = StartReleaseTime;
+                // the time of click, to wait the next click
+                StartReleaseTime = _tick;
+                ReleaseSet = HasClicks && Clicks != 0;
+                if (sta != BtnSta_None) {
+                    callEvent(_tick,sta);
+                }
+                return BtnSta_Clicked;
+            }
+        }
+        else if (ReleaseSet && since(_tick,StartReleaseTime) >= DebounceTime) {
+            ReleaseSet = false;
+        }
+        // btn is Keep pressing
+        if (!PressSet) {
+            StartPresseTime = _tick;
+            PressSet = true;
+        }
+        if (since(_tick,StartPresseTime) >= _Timing::LongPress) {
+            ReleaseSet = false;
+            PressTimeBuf = StartPresseTime + _Timing::LongPress + _Timing::Repeat;
+            RepeatPeriod = _Timing::Repeat;
+            // a long press ends the clicks
+            if (HasClicks && Clicks != 0) {
+                clickTimeout(_tick);
+            }
+            callEvent(_tick,BtnSta_LongPressing);
+            return BtnSta_LongPressing;
+        }
+        if (HasEvent && since(_tick,PressTimeBuf) > _Timing::Pressing) {
+            PressTimeBuf = _tick;
+            callEvent(_tick,BtnSta_Pressing);
+        }
+        return BtnSta_Pressing;
+    }
+
+    inline z_btn_state_t longPressingProc(uint32_t _tick,uint8_t _level) {
+        // button release detected
+        if (_level == 0) {
+            if (!ReleaseSet) {
+                StartReleaseTime = _tick;
+                ReleaseSet = true;
+            }
+            if (since(_tick,StartReleaseTime) >= DebounceTime) {
+                ReleaseSet = false;
+                EdgeTime = StartReleaseTime;
+                callEvent(_tick,BtnSta_Pressed);
+                return BtnSta_Pressed;
+            }
+        }
+        else if (ReleaseSet && since(_tick,StartReleaseTime) >= DebounceTime) {
+            ReleaseSet = false;
+        }
+        // every repeat that is due, also when the tick is late
+        while (HasRepeat && since(_tick,PressTimeBuf) < 0x80000000UL) {
+            // faster after each repeat, down to RepeatMin
+            if (_Timing::RepeatStep != 0) {
+                RepeatPeriod = RepeatPeriod > _Timing::RepeatMin + _Timing::RepeatStep ?
+                               RepeatPeriod - _Timing::RepeatStep : _Timing::RepeatMin;
+            }
+            PressTimeBuf += RepeatPeriod;
+            callEvent(_tick,BtnSta_LongPressed_Repeat);
+        }
+        return BtnSta_LongPressing;
+    }
+
+    inline z_btn_state_t pressedOrClickedProc(uint32_t _tick) {
+        if (!HasClicks || Clicks == 0) {
+            ReleaseSet = false;
+        }
+        PressSet = false;
+        PreState = BtnSta_Pressed;
+        callEvent(_tick,BtnSta_Releasing);
+        return BtnSta_Releasing;
+    }
+};
+
+// List of buttons, one member per button, handled in order
+template <class... _Btns>
+struct ButtonList {
+    inline void proc(uint32_t) {}
+};
+
+template <class _Head, class... _Tail>
+struct ButtonList<_Head,_Tail...> {
+    _Head Head;
+    ButtonList<_Tail...> Tail;
+    inline void proc(uint32_t _tick) {
+        Head.proc(_tick);
+        Tail.proc(_tick);
+    }
+};
+
+// Button at index _I of a ButtonList
+template <unsigned _I,class _List>
+struct ButtonAt;
+
+template <class _Head, class... _Tail>
+struct ButtonAt<0,ButtonList<_Head,_Tail...> > {
+    typedef _Head Type;
+    static inline Type& get(ButtonList<_Head,_Tail...>& _list) { return _list.Head; }
+};
+
+template <unsigned _I, class _Head, class... _Tail>
+struct ButtonAt<_I,ButtonList<_Head,_Tail...> > {
+    typedef typename ButtonAt<_I - 1,ButtonList<_Tail...> >::Type Type;
+    static inline Type& get(ButtonList<_Head,_Tail...>& _list) {
+        return ButtonAt<_I - 1,ButtonList<_Tail...> >::get(_list.Tail);
+    }
+};
+
+/**-------------------------------------------------------------------
+ * @class  : ButtonManager
+ * @brief  : A set of buttons known at compile time, in place of
+ *           z_btnmgr_init / z_btnmgr_regBtn / z_btnmgr_tick.
+ *           Several managers can be used, each has its own tick count.
+ * @param  : _Btns  - the Button<...> types
+ */
+template <class... _Btns>
+class ButtonManager {
+public:
+    static constexpr unsigned Count = sizeof...(_Btns);
+
+    inline void tick(uint32_t _ms) {
+        TickCount += _ms;
+        Btns.proc(TickCount);
+    }
+    // tick to the time of a free running clock, it may wrap
+    inline void tickTo(uint32_t _now) {
+        TickCount = _now;
+        Btns.proc(TickCount);
+    }
+    uint32_t getTickCount(void) const {
+        return TickCount;
+    }
+    template <unsigned _I>
+    typename ButtonAt<_I,ButtonList<_Btns...> >::Type& btn(void) {
+        return ButtonAt<_I,ButtonList<_Btns...> >::get(Btns);
+    }
+
+private:
+    uint32_t TickCount = 0;
+    ButtonList<_Btns...> Btns;
+};
+
+} // namespace z_btnmgr
+
+#endif // __z_BTNMGR_HPP__